@@ -1,6 +1,9 @@
 import os, sys
 import argparse
 import hashlib
+import re
+import subprocess
+import struct
 from elftools.elf.elffile import ELFFile
 from elftools.elf.relocation import RelocationSection
 from elftools.elf.sections import SymbolTableSection
@@ -69,6 +72,121 @@ def get_wrapped_name(n):
     s = hashlib.md5(n).hexdigest()
     return "__%s__%s" % (s[:9], n)
 
+# Hash of a symbol name (32-bit FNV-1a, must be kept in sync with 'get_name_hash' in udynlink.c)
+# A non-zero seed changes the initial value of the hash (used by the perfect hash in mkmanifest).
+def get_name_hash(n, seed = 0):
+    h = 2166136261 ^ seed
+    for c in n:
+        h = ((h ^ ord(c)) * 16777619) & 0xFFFFFFFF
+    return h
+
+# Read a host export manifest. Each line has the ordinal of a host symbol, its name and optionally its ABI (the rest
+# of the line, for example its C prototype). Ordinals must be unique and shouldn't change once used by a module.
+# Empty lines and lines starting with '#' are ignored.
+# Returns a dictionary that maps each name to its (ordinal, hash) pair. The hash covers both the name and the ABI.
+def read_host_manifest(fname):
+    res, ordinals = {}, {}
+    with open(fname, "rt") as f:
+        for n, line in enumerate(f.readlines()):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            parts = line.split(None, 2)
+            check(len(parts) >= 2 and parts[0].isdigit(), "%s:%d: invalid manifest entry '%s'" % (fname, n + 1, line))
+            ordinal, name, abi = int(parts[0]), parts[1], " ".join(parts[2].split()) if len(parts) > 2 else ""
+            check(ordinal < 0x10000, "%s:%d: ordinal %d out of range" % (fname, n + 1, ordinal))
+            check(not ordinals.has_key(ordinal), "%s:%d: duplicate ordinal %d" % (fname, n + 1, ordinal))
+            check(not res.has_key(name), "%s:%d: duplicate symbol '%s'" % (fname, n + 1, name))
+            res[name] = (ordinal, get_name_hash(name + ":" + abi if abi else name))
+            ordinals[ordinal] = name
+    return res
+
+# Read a list of hot functions (mkmodule --hot-functions). Each line has the name of a function, optionally followed by
+# other fields that are ignored (like the call count or the time spent in the function, as written by a profiler).
+# Empty lines and lines starting with '#' are ignored.
+def read_hot_functions(fname):
+    res = set()
+    with open(fname, "rt") as f:
+        for line in f.readlines():
+            line = line.strip()
+            if line and not line.startswith("#"):
+                res.add(line.split()[0])
+    return res
+
+# Read a call count profile (mkmodule --function-order). Each line has the name of a function and the number of times
+# it was called. Empty lines and lines starting with '#' are ignored.
+# Returns a dictionary that maps each name to its call count.
+def read_function_profile(fname):
+    res = {}
+    with open(fname, "rt") as f:
+        for n, line in enumerate(f.readlines()):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            parts = line.split()
+            check(len(parts) >= 2 and parts[1].isdigit(), "%s:%d: invalid profile entry '%s'" % (fname, n + 1, line))
+            res[parts[0]] = res.get(parts[0], 0) + int(parts[1])
+    return res
+
+# Read the symbol table of a module image (as generated by mkmodule). Returns a list with a dictionary for each symbol,
+# with its name (None if not in the image), type (0 = local, 1 = exported, 2 = extern, 3 = module name), value and,
+# for symbols imported by ordinal, the ordinal (the value is the hash of the symbol in this case).
+def get_symbols_in_image(fname):
+    with open(fname, "rb") as f:
+        img = f.read()
+    sign, _, num_rels, _, _, _, _ = struct.unpack_from("<4sHHIIII", img, 0)
+    check(sign == "UDLM", "'%s' is not a module image" % fname)
+    symt = 24 + num_rels * 8
+    first = struct.unpack_from("<I", img, symt)[0]
+    count, ordinals = first & 0x00FFFFFF, (first >> 24) & 0x02
+    res = []
+    for i in range(count):
+        off, val = struct.unpack_from("<II", img, symt + 4 + i * 8)
+        sdata = {"type": (off >> 28) & 3, "value": val, "name": None, "ordinal": None}
+        if ordinals and sdata["type"] == 2:
+            sdata["ordinal"] = off & 0x0FFFFFFF
+        elif sdata["type"] != 0:
+            name_off = symt + (off & 0x0FFFFFFF)
+            sdata["name"] = img[name_off:img.index('\0', name_off)]
+        res.append(sdata)
+    return res
+
+# Compress the given data as a single LZ4 block (greedy matching with a hash table of 4 byte sequences). The format
+# rules: matches are at least 4 bytes long, the last 5 bytes are always literals and the last match starts at least
+# 12 bytes before the end of the data. Must be kept in sync with 'lz4_decompress' in udynlink.c.
+def lz4_compress(data):
+    data, out = str(data), bytearray()
+    def put_len(l):
+        while l >= 255:
+            out.append(255)
+            l -= 255
+        out.append(l)
+    def put_seq(lit, off, mlen):
+        ml = mlen - 4 if off else 0
+        out.append((min(len(lit), 15) << 4) | min(ml, 15))
+        if len(lit) >= 15:
+            put_len(len(lit) - 15)
+        out.extend(lit)
+        if off:
+            out.extend(struct.pack("<H", off))
+            if ml >= 15:
+                put_len(ml - 15)
+    n, table, anchor, i = len(data), {}, 0, 0
+    if n == 0:
+        return ""
+    while i < n - 12:
+        cand, table[data[i:i + 4]] = table.get(data[i:i + 4]), i
+        if cand is None or i - cand > 0xFFFF:
+            i += 1
+            continue
+        mlen = 4
+        while i + mlen < n - 5 and data[cand + mlen] == data[i + mlen]:
+            mlen += 1
+        put_seq(data[anchor:i], i - cand, mlen)
+        i = anchor = i + mlen
+    put_seq(data[anchor:], 0, 0)
+    return str(out)
+
 debug_col = 'blue'
 def debug(msg, args, col = None):
     if not args.no_debug:
@@ -133,6 +251,16 @@ def get_symbols_in_elf(obj):
 def get_public_functions_in_object(obj):
     return [s for s, d in get_symbols_in_elf(obj).items() if d["type"] == "STT_FUNC" and d["bind"] == "STB_GLOBAL"]
 
+# Returns the names of the sections in the given ELF
+def get_sections_in_elf(obj):
+    with open(obj, "rb") as f:
+        return [str(section.name) for section in ELFFile(f).iter_sections()]
+
+# Returns the name of the section that holds each public function in the given object
+def get_function_sections_in_object(obj):
+    names = get_sections_in_elf(obj)
+    return {s: names[d["section"]] for s, d in get_symbols_in_elf(obj).items() if d["type"] == "STT_FUNC" and d["bind"] == "STB_GLOBAL"}
+
 def get_relocations_in_elf(obj):
     rels = []
     with open(obj, "rb") as f:
@@ -141,10 +269,12 @@ def get_relocations_in_elf(obj):
             if not isinstance(section, RelocationSection):
                 continue
             symtable = elf.get_section(section['sh_link'])
+            target = elf.get_section(section['sh_info']).name
             for rel in section.iter_relocations():
                 if rel['r_info_sym'] == 0:
                     continue
                 rdata = {}
+                rdata["section"] = str(target) # section the relocation applies to
                 rdata["offset"] = int(rel['r_offset'])
                 rdata["info"] = rel['r_info']
                 rdata["type"] = describe_reloc_type(rel['r_info_type'], elf)
@@ -175,3 +305,52 @@ def get_section_in_elf(obj, section_name):
         else:
             error("Section '%s' not found" % section_name)
     return sect
+
+# Overwrite the data of the given section (as returned by get_section_in_elf) in the input ELF
+def patch_section_in_elf(obj, sect, data):
+    check(len(data) == sect["size"], "Can't change the size of section '%s'" % sect["name"])
+    with open(obj, "r+b") as f:
+        f.seek(sect["offset"])
+        f.write(data)
+
+# Change the offset of a 32-bit Thumb branch instruction (given as two halfwords), according to the relocation type
+# Returns the new halfwords.
+def encode_thumb_branch(hw1, hw2, rtype, offset):
+    check(offset % 2 == 0, "Invalid branch offset %d" % offset)
+    if rtype == "R_ARM_THM_JUMP19": # B<c>.W (encoding T3), +/-1MB
+        check(-(1 << 20) <= offset < (1 << 20), "Branch offset %d out of range" % offset)
+        s, j2, j1 = (offset >> 20) & 1, (offset >> 19) & 1, (offset >> 18) & 1
+        hw1 = (hw1 & 0xFBC0) | (s << 10) | ((offset >> 12) & 0x3F)
+    else: # BL (encoding T1) and B.W (encoding T4), +/-16MB
+        check(-(1 << 24) <= offset < (1 << 24), "Branch offset %d out of range" % offset)
+        s = (offset >> 24) & 1
+        j1, j2 = (~((offset >> 23) ^ s)) & 1, (~((offset >> 22) ^ s)) & 1
+        hw1 = (hw1 & 0xF800) | (s << 10) | ((offset >> 12) & 0x3FF)
+    hw2 = (hw2 & 0xD000) | (j1 << 13) | (j2 << 11) | ((offset >> 1) & 0x7FF)
+    return hw1, hw2
+
+# Disassemble the given section of the input ELF, returning a list with the instructions found.
+# Each instruction is a dictionary with its address, size, raw data (list of halfwords for code, a single word
+# for data), mnemonic, operands and target. The target is the address mentioned in the operands (for branches)
+# or in the comment (for PC-relative loads), or None.
+def get_instructions_in_elf(obj, section = ".text"):
+    insns = []
+    out = subprocess.check_output(["arm-none-eabi-objdump", "-d", "-w", "-z", "-j", section, obj])
+    for line in out.splitlines():
+        parts = line.split('\t')
+        m = re.match(r"^\s*([0-9a-f]+):$", parts[0])
+        if not m or len(parts) < 3:
+            continue
+        raw = [int(h, 16) for h in parts[1].split()]
+        idata = {"addr": int(m.group(1), 16), "mnemonic": parts[2].strip(), "target": None}
+        idata["size"] = 2 * len(raw) if idata["mnemonic"] != ".word" else 4
+        idata["raw"] = raw
+        rest = "\t".join(parts[3:])
+        # The comment (if any) starts with ';' or '@'
+        m = re.match(r"^([^;@]*)[;@]?(.*)$", rest)
+        idata["operands"], comment = m.group(1).strip(), m.group(2)
+        m = re.search(r"\b([0-9a-f]+) <[^>]+>", idata["operands"]) or re.search(r"\(([0-9a-f]+) <[^>]+>\)", comment)
+        if m:
+            idata["target"] = int(m.group(1), 16)
+        insns.append(idata)
+    return insns
@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+# Compare the module images built by the GCC (LOT) and the clang (ROPI/RWPI) backends of mkmodule
+# Usage: bench_toolchains.py [--run] [test-dir ...]
+# With --run, the tests are also run in QEMU with both backends (through test_driver.py) and the timings that they
+# print ("... took N ms ...") are compared. Without test directories, --run uses the tests that require a timing in
+# their output (like test-recursion-bench).
+
+import os
+import re
+import sys
+import struct
+import subprocess
+
+mkmodule = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "scripts", "mkmodule"))
+toolchains = ["gcc", "clang-rwpi"]
+fields = ["num_lot", "num_rels", "symt_size", "code_size", "data_size", "bss_size"]
+
+# Build a module with the given toolchain and return the fields of its header and the size of its image (or None)
+def build(srcs, extra, toolchain):
+    name = "bench_" + toolchain.replace("-", "_")
+    cmd = [mkmodule, "--no-verbose", "--no-debug"] + extra.split() + ["--toolchain=" + toolchain, "--name", name] + srcs
+    with open(os.devnull, "w") as null:
+        if subprocess.call(cmd, stdout=null) != 0:
+            return None
+    with open(name + ".bin", "rb") as f:
+        img = f.read()
+    os.remove(name + ".bin")
+    hdr = struct.unpack_from("<4sHHIIII", img, 0)
+    res = dict(zip(fields, hdr[1:]))
+    res["image_size"] = len(img)
+    return res
+
+def read_test_data(d):
+    sys.path.append(d)
+    if sys.modules.has_key("test_data"):
+        del sys.modules["test_data"]
+    from test_data import test_data
+    sys.path.remove(d)
+    return test_data
+
+def bench_dir(d):
+    test_data = read_test_data(d)
+    cwd = os.getcwd()
+    os.chdir(d)
+    res = []
+    for m in test_data.get("modules", []):
+        extra = ""
+        if isinstance(m, dict):
+            extra, m = m.get("args", ""), m["sources"]
+        res.append((" ".join(m), [build(m, extra, t) for t in toolchains]))
+    os.chdir(cwd)
+    return res
+
+# Run the given tests with each backend and return the timings that they print, as a dictionary
+# {(test, opt, loader configuration, timing): [ms with each backend]} (test_driver.py runs each test with several
+# configurations of the loader). QEMU doesn't model the timing of the CPU (the time mostly follows the
+# number of executed instructions and the speed of the host), so only the ratio between the backends is meaningful.
+def run_timed(dirs):
+    driver = os.path.join(os.path.dirname(os.path.abspath(__file__)), "test_driver.py")
+    res = {}
+    for i, t in enumerate(toolchains):
+        child = subprocess.Popen([sys.executable, driver, "--show-output", "--mkmodule-args=--toolchain=" + t] + dirs, stdout=subprocess.PIPE)
+        out, _ = child.communicate()
+        test, opt, config = None, None, ""
+        for l in out.splitlines():
+            m = re.match(r"--- Running test .* in '(\S+)' with opt (\S+) ---", l)
+            if m:
+                test, opt = m.groups()
+            elif l.startswith("Loader configuration: "):
+                config = l.split(":", 1)[1].strip().replace("UDYNLINK_", "")
+            elif test and re.search(r"took \d+ ms", l):
+                m = re.match(r"(.*)took (\d+) ms([^,]*)", l)
+                res.setdefault((test, opt, config, " ".join((m.group(1) + m.group(3)).split())), [None] * len(toolchains))[i] = int(m.group(2))
+    return res
+
+run = "--run" in sys.argv[1:]
+given = [a for a in sys.argv[1:] if a != "--run"]
+dirs = given or sorted([l for l in os.listdir(".") if l.startswith("test-") and os.path.isfile(os.path.join(l, "test_data.py"))])
+cols = ["num_lot", "num_rels", "code_size", "image_size"]
+print "%-24s %-28s" % ("test", "module") + "".join(["%16s" % c for c in cols])
+print "%-24s %-28s" % ("", "") + "".join(["%16s" % " / ".join(["gcc", "rwpi"]) for c in cols])
+totals = [dict([(c, 0) for c in cols]) for t in toolchains]
+for d in dirs:
+    for srcs, results in bench_dir(os.path.abspath(d)):
+        line = "%-24s %-28s" % (d, srcs[:28])
+        for c in cols:
+            line += "%16s" % " / ".join(["%d" % r[c] if r else "n/a" for r in results])
+        print line
+        if all(results):
+            for i, r in enumerate(results):
+                for c in cols:
+                    totals[i][c] += r[c]
+print "%-24s %-28s" % ("total", "") + "".join(["%16s" % " / ".join(["%d" % t[c] for t in totals]) for c in cols])
+if run:
+    timed = given or [d for d in dirs if any("took" in r for r in read_test_data(os.path.abspath(d)).get("required", []))]
+    print
+    print "%-24s %-4s %-28s %-56s %16s" % ("test", "opt", "loader", "timing", "ms gcc / rwpi")
+    for (test, opt, config, desc), results in sorted(run_timed(timed).items()):
+        print "%-24s %-4s %-28s %-56s %16s" % (test, opt, config[:28], desc[:56], " / ".join(["%d" % r if r is not None else "n/a" for r in results]))
@@ -4,5 +4,8 @@
 
 USER_OBJS :=
 
-LIBS :=
+# Extra libraries of the test (test_driver.py sets them from the 'libs' entry of the test data)
+TEST_LIBS ?=
+
+LIBS := $(TEST_LIBS)
 
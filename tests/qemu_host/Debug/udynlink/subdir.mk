@@ -2,6 +2,11 @@
 # Automatically-generated file. Do not edit!
 ################################################################################
 
+# Configuration of the loader (the tests can override it on the make command line)
+UDYNLINK_MAX_HANDLES ?= 8
+UDYNLINK_HANDLE_CHUNK ?= 8
+UDYNLINK_EXPORT_INDEX ?= 1
+
 # Add inputs and outputs from these tool invocations to the build variables
 C_SRCS += \
 ../../../../udynlink/udynlink.c
@@ -15,7 +20,7 @@ C_DEPS += \
 udynlink/%.o: ../../../udynlink/%.c
 	@echo 'Building file: $<'
 	@echo 'Invoking: Cross ARM C Compiler'
-	arm-none-eabi-gcc -mcpu=cortex-m4 -mthumb -mfloat-abi=soft -Og -fmessage-length=0 -fsigned-char -ffunction-sections -fdata-sections -fno-move-loop-invariants -Wall -Wextra  -g3 -DDEBUG -DUSE_FULL_ASSERT -DOS_USE_SEMIHOSTING -DTRACE -DOS_USE_TRACE_SEMIHOSTING_DEBUG -DSTM32F429xx -DUSE_HAL_DRIVER -DHSE_VALUE=8000000 -I"../include" -I"../system/include" -I"../system/include/cmsis" -I"../system/include/stm32f4-hal" -std=gnu11 -Wno-format -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -c -o "$@" "$<"
+	arm-none-eabi-gcc -mcpu=cortex-m4 -mthumb -mfloat-abi=soft -Og -fmessage-length=0 -fsigned-char -ffunction-sections -fdata-sections -fno-move-loop-invariants -Wall -Wextra  -g3 -DDEBUG -DUSE_FULL_ASSERT -DOS_USE_SEMIHOSTING -DTRACE -DOS_USE_TRACE_SEMIHOSTING_DEBUG -DSTM32F429xx -DUSE_HAL_DRIVER -DHSE_VALUE=8000000 -DUDYNLINK_MAX_HANDLES=$(UDYNLINK_MAX_HANDLES) -DUDYNLINK_HANDLE_CHUNK=$(UDYNLINK_HANDLE_CHUNK) -DUDYNLINK_EXPORT_INDEX=$(UDYNLINK_EXPORT_INDEX) -DUDYNLINK_FLASH_LOT=1 -I"../include" -I"../system/include" -I"../system/include/cmsis" -I"../system/include/stm32f4-hal" -std=gnu11 -Wno-format -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -c -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -39,6 +39,19 @@ uint32_t udynlink_external_resolve_symbol(const char *name) {
         return test_resolve_symbol(name);
 }
 
+// Tests that install modules provide their own (simulated) flash
+int test_flash_write(void *p_dst, const void *p_src, uint32_t size) __attribute__((weak));
+int test_flash_write(void *p_dst, const void *p_src, uint32_t size) {
+    (void)p_dst;
+    (void)p_src;
+    (void)size;
+    return 0;
+}
+
+int udynlink_external_flash_write(void *p_dst, const void *p_src, uint32_t size) {
+    return test_flash_write(p_dst, p_src, size);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Test me!
 
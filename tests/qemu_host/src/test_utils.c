@@ -1,4 +1,5 @@
 #include "udynlink.h"
+#include "stm32f4xx_hal.h"
 #include <stdio.h>
 
 int is_exported_symbol(const udynlink_module_t *p_mod, const char *name) {
@@ -51,3 +52,6 @@ int run_test_func(const udynlink_module_t *p_mod) {
     return p_func();
 }
 
+uint32_t get_ms_ticks(void) {
+    return HAL_GetTick();
+}
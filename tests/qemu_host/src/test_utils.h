@@ -16,6 +16,7 @@ int is_extern_symbol(const udynlink_module_t *p_mod, const char *name);
 int check_exported_symbols(const udynlink_module_t *p_mod, const char *slist[]);
 int check_extern_symbols(const udynlink_module_t *p_mod, const char *slist[]);
 int run_test_func(const udynlink_module_t *p_mod);
+uint32_t get_ms_ticks(void);
 
 #endif
 
@@ -0,0 +1,30 @@
+// Module with repetitive code and data, to give the compressor something to work with
+
+#include <stdio.h>
+
+#define TABLE_SIZE          256
+
+// In .rodata (part of the code)
+static const unsigned short const_table[TABLE_SIZE] = {
+#define ROW(n)  n, n + 1, n + 2, n + 3, n + 4, n + 5, n + 6, n + 7, n + 8, n + 9, n + 10, n + 11, n + 12, n + 13, n + 14, n + 15
+    ROW(0), ROW(16), ROW(32), ROW(48), ROW(64), ROW(80), ROW(96), ROW(112),
+    ROW(128), ROW(144), ROW(160), ROW(176), ROW(192), ROW(208), ROW(224), ROW(240)
+};
+
+// In .data
+int data_table[TABLE_SIZE] = {
+    ROW(0), ROW(0), ROW(0), ROW(0), ROW(0), ROW(0), ROW(0), ROW(0),
+    ROW(0), ROW(0), ROW(0), ROW(0), ROW(0), ROW(0), ROW(0), ROW(0)
+#undef ROW
+};
+
+int test(void) {
+    int sum = 0;
+
+    printf("Running test '%s'\n", "mod_compressed");
+    for (int i = 0; i < TABLE_SIZE; i ++) {
+        sum += const_table[i] - data_table[i];
+    }
+    // sum(0..255) - 16 * sum(0..15)
+    return sum == 32640 - 16 * 120;
+}
@@ -0,0 +1,8 @@
+# Test compressed module images, which are decompressed while loading
+
+test_data = {
+    "desc": "Compressed module images",
+    "modules": [{"sources": ["mod_compressed.c"], "args": "--compress"}, {"sources": ["mod_compressed.c"], "args": "--name mod_uncompressed"}],
+    "required": ["Running test 'mod_compressed'"],
+    "total_loads": 5
+}
@@ -0,0 +1,76 @@
+#include "udynlink.h"
+#include "mod_compressed_module_data.h"
+#include "mod_uncompressed_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_LOADS                         100
+
+static int run_test(const unsigned char *p_image, udynlink_load_mode_t mode) {
+    const char *exported_syms[] = {"test", "data_table", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module(p_image, NULL, 0, mode, NULL)) == NULL)
+        return 0;
+    CHECK_RAM_SIZE(p_mod, 256 * sizeof(int));
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
+
+// Return the time (in ms) needed to load and unload the image BENCH_LOADS times
+static int bench_loads(const unsigned char *p_image, udynlink_load_mode_t mode, uint32_t *p_ms) {
+    udynlink_module_t *p_mod;
+    uint32_t start = get_ms_ticks();
+
+    for (int i = 0; i < BENCH_LOADS; i ++) {
+        if ((p_mod = udynlink_load_module(p_image, NULL, 0, mode, NULL)) == NULL)
+            return 0;
+        udynlink_unload_module(p_mod);
+    }
+    *p_ms = get_ms_ticks() - start;
+    return 1;
+}
+
+int test_qemu(void) {
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    uint32_t comp_ms, uncomp_ms;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if (!run_test(mod_uncompressed_module_data, (udynlink_load_mode_t)i))
+            return 0;
+        // Compressed code must be copied to RAM
+        if (i == UDYNLINK_LOAD_MODE_XIP) {
+            if (((p_mod = udynlink_load_module(mod_compressed_module_data, NULL, 0, UDYNLINK_LOAD_MODE_XIP, &err)) != NULL) || (err != UDYNLINK_ERR_LOAD_UNABLE_TO_XIP)) {
+                printf("Compressed module loaded in XIP mode\n");
+                if (p_mod)
+                    udynlink_unload_module(p_mod);
+                return 0;
+            }
+        } else if (!run_test(mod_compressed_module_data, (udynlink_load_mode_t)i))
+            return 0;
+    }
+    // Compare the load times (the module is in flash in both cases)
+    if (!bench_loads(mod_uncompressed_module_data, UDYNLINK_LOAD_MODE_COPY_CODE, &uncomp_ms) || !bench_loads(mod_compressed_module_data, UDYNLINK_LOAD_MODE_COPY_CODE, &comp_ms))
+        return 0;
+    printf("Image size: %u bytes compressed, %u bytes uncompressed (%u%%)\n", (unsigned)sizeof(mod_compressed_module_data),
+           (unsigned)sizeof(mod_uncompressed_module_data), (unsigned)(sizeof(mod_compressed_module_data) * 100 / sizeof(mod_uncompressed_module_data)));
+    printf("%d loads took %u ms compressed, %u ms uncompressed\n", BENCH_LOADS, comp_ms, uncomp_ms);
+    if (comp_ms > 0) {
+        // Includes the relocation time, so this is a lower bound for the decompression speed
+        const udynlink_module_header_t *p_header = (const udynlink_module_header_t*)mod_compressed_module_data;
+        printf("Loaded %u KB/s of compressed code and data\n", (p_header->code_size + p_header->data_size) * BENCH_LOADS / comp_ms);
+    }
+    return 1;
+}
@@ -0,0 +1,13 @@
+#include <stdio.h>
+
+int counter;
+
+int inc(int v) {
+    counter += v;
+    return counter;
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_direct_wrapper");
+    return inc(2) == 2 && inc(3) == 5;
+}
@@ -0,0 +1,8 @@
+# Test export wrappers that read the LOT base directly (no LOT base lookup)
+
+test_data = {
+    "desc": "Direct LOT base export wrappers",
+    "modules": [{"sources": ["mod_direct_wrapper.c"], "args": "--wrapper direct"}],
+    "required": ["Running test 'mod_direct_wrapper'"],
+    "total_loads": 2
+}
@@ -0,0 +1,46 @@
+#include "udynlink.h"
+#include "udynlink_externals.h"
+#include "mod_direct_wrapper_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+int test_qemu(void) {
+    const char *exported_syms[] = {"test", "inc", "counter", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    uint32_t hits, misses;
+    int res = 0;
+
+    // The module was built without a LOT slot for XIP, so it can't be executed in place
+    if ((udynlink_load_module(mod_direct_wrapper_module_data, NULL, 0, UDYNLINK_LOAD_MODE_XIP, &err) != NULL) || (err != UDYNLINK_ERR_LOAD_UNABLE_TO_XIP)) {
+        printf("Module shouldn't load in XIP mode\n");
+        return 0;
+    }
+    for (int i = (int)UDYNLINK_LOAD_MODE_COPY_ALL; i <= (int)UDYNLINK_LOAD_MODE_COPY_CODE; i ++) {
+        if ((p_mod = udynlink_load_module(mod_direct_wrapper_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, sizeof(int));
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!check_extern_symbols(p_mod, extern_syms))
+            goto exit;
+        udynlink_reset_lot_base_stats();
+        if (!run_test_func(p_mod))
+            goto exit;
+        // Calls through the wrappers must not look up the LOT base
+        udynlink_get_lot_base_stats(&hits, &misses);
+        if (hits + misses != 0) {
+            printf("Unexpected LOT base lookups (%u)\n", hits + misses);
+            goto exit;
+        }
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
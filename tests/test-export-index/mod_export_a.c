@@ -0,0 +1,18 @@
+// Module that exports 'shared' (also exported by mod_export_b) and its own symbols
+
+#include <stdio.h>
+
+int a_value = 10;
+
+int shared(void) {
+    return 1;
+}
+
+int only_a(void) {
+    return a_value;
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_export_a");
+    return (shared() == 1) && (only_a() == 10);
+}
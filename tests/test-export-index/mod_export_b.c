@@ -0,0 +1,18 @@
+// Module that exports 'shared' (also exported by mod_export_a) and its own symbols
+
+#include <stdio.h>
+
+int b_value = 20;
+
+int shared(void) {
+    return 2;
+}
+
+int only_b(void) {
+    return b_value;
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_export_b");
+    return (shared() == 2) && (only_b() == 20);
+}
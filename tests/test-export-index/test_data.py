@@ -0,0 +1,7 @@
+# Test symbol lookups in all loaded modules through the global export index
+
+test_data = {
+    "desc": "Global export index",
+    "modules": [["mod_export_a.c"], ["mod_export_b.c"]],
+    "required": ["Running test 'mod_export_a'", "Running test 'mod_export_b'"]
+}
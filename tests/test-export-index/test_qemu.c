@@ -0,0 +1,69 @@
+#include "udynlink.h"
+#include "mod_export_a_module_data.h"
+#include "mod_export_b_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+// Call the function with the given name found in any of the loaded modules
+static int call_global(const char *name) {
+    int (*p_func)(void) = (int (*)(void))udynlink_get_symbol_value(NULL, name);
+
+    return p_func == NULL ? -1 : p_func();
+}
+
+int test_qemu(void) {
+    udynlink_module_t *p_mod_a = NULL, *p_mod_b = NULL;
+    uint32_t exports, dups, prev_dups;
+    udynlink_sym_t sym;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        udynlink_get_export_index_stats(NULL, &prev_dups);
+        if ((p_mod_a = udynlink_load_module(mod_export_a_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            goto exit;
+        if ((p_mod_b = udynlink_load_module(mod_export_b_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            goto exit;
+        // Both modules export 'test', 'shared' and a variable and a function of their own
+        udynlink_get_export_index_stats(&exports, &dups);
+        if ((exports != 8) || (dups != prev_dups + 2)) {
+            printf("Unexpected export index stats: %u exports, %u duplicates\n", exports, dups - prev_dups);
+            goto exit;
+        }
+        if ((call_global("only_a") != 10) || (call_global("only_b") != 20) || (*(int*)udynlink_get_symbol_value(NULL, "b_value") != 20)) {
+            printf("Unexpected result from a global lookup\n");
+            goto exit;
+        }
+        // The module loaded first wins
+        if (call_global("shared") != 1) {
+            printf("'shared' not found in the first module\n");
+            goto exit;
+        }
+        // Extern symbols are not exports
+        if ((udynlink_lookup_symbol(NULL, "printf", &sym) != NULL) || (udynlink_lookup_symbol(p_mod_a, "only_b", &sym) != NULL)) {
+            printf("Found a symbol that isn't exported\n");
+            goto exit;
+        }
+        if (!run_test_func(p_mod_a) || !run_test_func(p_mod_b))
+            goto exit;
+        udynlink_unload_module(p_mod_a);
+        p_mod_a = NULL;
+        if ((call_global("shared") != 2) || (call_global("only_a") != -1)) {
+            printf("Unexpected global lookup result after unloading the first module\n");
+            goto exit;
+        }
+        udynlink_unload_module(p_mod_b);
+        p_mod_b = NULL;
+        udynlink_get_export_index_stats(&exports, NULL);
+        if ((exports != 0) || (udynlink_lookup_symbol(NULL, "shared", &sym) != NULL)) {
+            printf("Export index not empty after unloading all modules\n");
+            goto exit;
+        }
+    }
+    res = 1;
+exit:
+    if (p_mod_a)
+        udynlink_unload_module(p_mod_a);
+    if (p_mod_b)
+        udynlink_unload_module(p_mod_b);
+    return res;
+}
@@ -0,0 +1,11 @@
+// Module loaded several times (with different names) to fill the module table
+
+#include <stdio.h>
+
+int runs;
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_fixed");
+    runs ++;
+    return runs > 0;
+}
@@ -0,0 +1,9 @@
+# Test the fixed module table (UDYNLINK_MAX_HANDLES > 0): the same module is built with different names to fill it.
+# Without the export index, the lookups of exported symbols search the loaded modules in the table.
+
+test_data = {
+    "desc": "Fixed module table",
+    "modules": [{"sources": ["mod_fixed.c"], "args": "--name mod_fixed%d" % i} for i in range(5)],
+    "required": ["Running test 'mod_fixed'"],
+    "udynlink_config": {"UDYNLINK_MAX_HANDLES": 4, "UDYNLINK_EXPORT_INDEX": 0}
+}
@@ -0,0 +1,78 @@
+#include "udynlink.h"
+#include "mod_fixed0_module_data.h"
+#include "mod_fixed1_module_data.h"
+#include "mod_fixed2_module_data.h"
+#include "mod_fixed3_module_data.h"
+#include "mod_fixed4_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+#define MAX_HANDLES         4           // UDYNLINK_MAX_HANDLES in test_data.py
+
+static const void * const images[MAX_HANDLES + 1] = {mod_fixed0_module_data, mod_fixed1_module_data, mod_fixed2_module_data,
+    mod_fixed3_module_data, mod_fixed4_module_data};
+
+static int run_test(udynlink_load_mode_t mode) {
+    udynlink_module_t *p_mods[MAX_HANDLES] = {NULL};
+    udynlink_module_t *p_freed;
+    udynlink_error_t err;
+    udynlink_sym_t sym;
+    int res = 0, i;
+
+    for (i = 0; i < MAX_HANDLES; i ++) {
+        if ((p_mods[i] = udynlink_load_module(images[i], NULL, 0, mode, &err)) == NULL) {
+            printf("Unable to load module %d (error %d)\n", i, (int)err);
+            goto exit;
+        }
+    }
+    if ((udynlink_load_module(images[MAX_HANDLES], NULL, 0, mode, &err) != NULL) || (err != UDYNLINK_ERR_LOAD_NO_MORE_HANDLES)) {
+        printf("Module loaded in a full module table\n");
+        goto exit;
+    }
+    for (i = 0; i < MAX_HANDLES; i ++) {
+        if (udynlink_lookup_module(udynlink_get_module_name(p_mods[i])) != p_mods[i]) {
+            printf("Module %d not found by name\n", i);
+            goto exit;
+        }
+        if (!run_test_func(p_mods[i]))
+            goto exit;
+    }
+    // The search for a symbol in all the modules skips a freed entry, and the next load uses it again
+    p_freed = p_mods[0];
+    udynlink_unload_module(p_freed);
+    p_mods[0] = NULL;
+    if ((udynlink_lookup_symbol(NULL, "test", &sym) == NULL) || (sym.val != udynlink_get_symbol_value(p_mods[1], "test"))) {
+        printf("Symbol not found in the next module\n");
+        goto exit;
+    }
+    if ((udynlink_load_module(images[1], NULL, 0, mode, &err) != NULL) || (err != UDYNLINK_ERR_LOAD_DUPLICATE_NAME)) {
+        printf("Module loaded twice\n");
+        goto exit;
+    }
+    if ((p_mods[0] = udynlink_load_module(images[MAX_HANDLES], NULL, 0, mode, &err)) != p_freed) {
+        printf("Freed entry not used again (error %d)\n", (int)err);
+        goto exit;
+    }
+    res = 1;
+exit:
+    for (i = MAX_HANDLES - 1; i >= 0; i --) {
+        if (p_mods[i])
+            udynlink_unload_module(p_mods[i]);
+    }
+    return res;
+}
+
+int test_qemu(void) {
+    static uint32_t handle_mem[64];
+
+    // The handles are in the module table, so there's no handle memory to add
+    if (udynlink_add_handle_memory(handle_mem, sizeof(handle_mem)) != 0) {
+        printf("Handle memory added to the fixed module table\n");
+        return 0;
+    }
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if (!run_test((udynlink_load_mode_t)i))
+            return 0;
+    }
+    return 1;
+}
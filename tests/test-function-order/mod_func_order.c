@@ -0,0 +1,73 @@
+// Module with hot functions (called in a loop) between functions that are called once or never. The functions don't use r9, so they
+// are exported without wrappers and their symbols point to their bodies.
+
+#include <stdio.h>
+
+unsigned cold_init(unsigned seed) {
+    unsigned x = seed;
+    for (int i = 0; i < 8; i ++) {
+        x = x * 1103515245 + 12345;
+        if (x & 0x80000000)
+            x ^= 0x5A5A5A5A;
+        else
+            x += i;
+    }
+    return x;
+}
+
+unsigned hot_mix(unsigned a, unsigned b) {
+    return (a ^ (b << 5) ^ (b >> 3)) + 0x9E3779B9;
+}
+
+unsigned cold_report(unsigned x, unsigned y) {
+    unsigned r = 0;
+    for (int i = 0; i < 32; i ++) {
+        if ((x >> i) & 1)
+            r += y << (i & 7);
+        else
+            r ^= y >> (i & 3);
+    }
+    return r;
+}
+
+unsigned hot_step(unsigned x) {
+    return (x >> 1) ^ (-(x & 1) & 0xEDB88320);
+}
+
+unsigned cold_check(unsigned x) {
+    switch (x & 7) {
+        case 0: return x + 1;
+        case 1: return x * 3;
+        case 2: return x ^ 0xFF;
+        case 3: return x - 7;
+        case 4: return x << 2;
+        case 5: return x >> 2;
+        default: return ~x;
+    }
+}
+
+unsigned hot_sum(unsigned acc, unsigned x) {
+    return acc + (x & 0xFFFF) + (x >> 16);
+}
+
+// Called only if the checksum is 0, which doesn't happen
+unsigned on_error(unsigned x) {
+    unsigned r = x;
+    for (int i = 0; i < 16; i ++) {
+        r = (r * 2654435761u) ^ (r >> 15);
+    }
+    return r | 1;
+}
+
+int test(void) {
+    unsigned x = cold_init(1), acc = 0;
+
+    printf("Running test '%s'\n", "mod_func_order");
+    for (int i = 0; i < 20000; i ++) {
+        x = hot_step(hot_mix(x, i));
+        acc = hot_sum(acc, x);
+    }
+    if (acc == 0)
+        return on_error(x) != 0;
+    return cold_check(cold_report(x, acc)) != 0;
+}
@@ -0,0 +1,12 @@
+# Benchmark profile-driven function ordering (hot functions at the start of .text, cold ones at the end of the code)
+# The first run is traced: mkprofile counts the calls of the plain module (the last one built, so mod_func_order.elf is
+# its ELF) and its counts are compared with profile.txt. Then the ordered module is rebuilt with the generated profile.
+
+test_data = {
+    "desc": "Function order benchmark",
+    "modules": [{"sources": ["mod_func_order.c"], "args": "--function-order profile.txt"}, {"sources": ["mod_func_order.c"], "args": "--name mod_func_order_plain"}],
+    "profile": {"elf": "mod_func_order.elf", "expected": "profile.txt"},
+    "rebuild": [{"sources": ["mod_func_order.c"], "args": "--function-order mod_func_order.profile"}],
+    "required": ["Running test 'mod_func_order'", "hot code spans"],
+    "total_loads": 4
+}
@@ -0,0 +1,69 @@
+#include "udynlink.h"
+#include "mod_func_order_module_data.h"
+#include "mod_func_order_plain_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+static const char *hot_funcs[] = {"hot_mix", "hot_step", "hot_sum", NULL};
+static const char *cold_funcs[] = {"cold_init", "cold_report", "cold_check", NULL};
+
+// Return the lowest and the highest address of the given functions
+static void get_range(udynlink_module_t *p_mod, const char **p_names, uint32_t *p_min, uint32_t *p_max) {
+    *p_min = 0xFFFFFFFF;
+    *p_max = 0;
+    for (; *p_names; p_names ++) {
+        uint32_t addr = udynlink_get_symbol_value(p_mod, *p_names);
+        *p_min = addr < *p_min ? addr : *p_min;
+        *p_max = addr > *p_max ? addr : *p_max;
+    }
+}
+
+// Run the module in the given mode and return the distance between its first and its last hot function
+static int run_bench(const unsigned char *p_image, const char *desc, udynlink_load_mode_t mode, uint32_t *p_span) {
+    const char *exported_syms[] = {"test", "hot_mix", "hot_step", "hot_sum", "cold_init", "cold_report", "cold_check", "on_error", NULL};
+    udynlink_module_t *p_mod;
+    uint32_t hot_min, hot_max, cold_min, cold_max, start;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module(p_image, NULL, 0, mode, NULL)) == NULL)
+        return 0;
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    // The address of the plain module in XIP mode (in flash, so no other module runs there) is used to find its
+    // functions in the QEMU trace of the test (see test_data.py)
+    if ((p_image == mod_func_order_plain_module_data) && (mode == UDYNLINK_LOAD_MODE_XIP))
+        printf("Profile anchor: test=0x%08X\n", (unsigned)udynlink_get_symbol_value(p_mod, "test"));
+    get_range(p_mod, hot_funcs, &hot_min, &hot_max);
+    get_range(p_mod, cold_funcs, &cold_min, &cold_max);
+    *p_span = hot_max - hot_min;
+    start = get_ms_ticks();
+    if (!run_test_func(p_mod))
+        goto exit;
+    start = get_ms_ticks() - start;
+    printf("%s: run took %u ms in load mode %d, hot code spans %u bytes\n", desc, start, (int)mode, *p_span);
+    // With the profile, the hot functions come first and the function that was never called comes last
+    if ((p_image == mod_func_order_module_data) && ((hot_max > cold_min) || (udynlink_get_symbol_value(p_mod, "on_error") < cold_max))) {
+        printf("Unexpected function order\n");
+        goto exit;
+    }
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    uint32_t span_ordered, span_plain;
+
+    for (int i = (int)UDYNLINK_LOAD_MODE_COPY_CODE; i <= (int)UDYNLINK_LOAD_MODE_XIP; i ++) {
+        if (!run_bench(mod_func_order_module_data, "ordered", (udynlink_load_mode_t)i, &span_ordered))
+            return 0;
+        if (!run_bench(mod_func_order_plain_module_data, "source order", (udynlink_load_mode_t)i, &span_plain))
+            return 0;
+        if (span_ordered >= span_plain) {
+            printf("The hot code isn't contiguous\n");
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,11 @@
+// Module loaded several times (with different names) to use more than one chunk of handles
+
+#include <stdio.h>
+
+int runs;
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_pool");
+    runs ++;
+    return runs > 0;
+}
@@ -0,0 +1,9 @@
+# Test the pool of module handles (UDYNLINK_MAX_HANDLES set to 0) with handle memory given by the application. Small
+# chunks of handles make the pool grow more than once with a few modules.
+
+test_data = {
+    "desc": "Module handle pool",
+    "modules": [{"sources": ["mod_pool.c"], "args": "--name mod_pool%d" % i} for i in range(5)],
+    "required": ["Running test 'mod_pool'"],
+    "udynlink_config": {"UDYNLINK_MAX_HANDLES": 0, "UDYNLINK_HANDLE_CHUNK": 2}
+}
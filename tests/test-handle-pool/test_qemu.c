@@ -0,0 +1,83 @@
+#include "udynlink.h"
+#include "mod_pool0_module_data.h"
+#include "mod_pool1_module_data.h"
+#include "mod_pool2_module_data.h"
+#include "mod_pool3_module_data.h"
+#include "mod_pool4_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+#define HANDLE_CHUNK        2           // UDYNLINK_HANDLE_CHUNK in test_data.py
+#define MEM_HANDLES         1
+// Use the handle in the given memory and two chunks of handles allocated by the loader
+#define NUM_MODULES         (MEM_HANDLES + 2 * HANDLE_CHUNK)
+
+static const void * const images[NUM_MODULES] = {mod_pool0_module_data, mod_pool1_module_data, mod_pool2_module_data,
+    mod_pool3_module_data, mod_pool4_module_data};
+// The internal handles are larger than udynlink_module_t, so this has space for a single one
+static udynlink_module_t handle_mem[MEM_HANDLES + 1];
+
+static int in_handle_mem(const udynlink_module_t *p_mod) {
+    return (p_mod >= handle_mem) && (p_mod < handle_mem + MEM_HANDLES + 1);
+}
+
+static int run_test(udynlink_load_mode_t mode) {
+    udynlink_module_t *p_mods[NUM_MODULES] = {NULL};
+    udynlink_module_t *p_first;
+    udynlink_error_t err;
+    int res = 0, i;
+
+    for (i = 0; i < NUM_MODULES; i ++) {
+        if ((p_mods[i] = udynlink_load_module(images[i], NULL, 0, mode, &err)) == NULL) {
+            printf("Unable to load module %d (error %d)\n", i, (int)err);
+            goto exit;
+        }
+    }
+    // The handle in the given memory is used first, then the ones allocated by the loader
+    for (i = 0; i < NUM_MODULES; i ++) {
+        if (in_handle_mem(p_mods[i]) != (i < MEM_HANDLES)) {
+            printf("Unexpected memory for handle %d (%p)\n", i, p_mods[i]);
+            goto exit;
+        }
+        if (udynlink_lookup_module(udynlink_get_module_name(p_mods[i])) != p_mods[i]) {
+            printf("Module %d not found by name\n", i);
+            goto exit;
+        }
+        if (!run_test_func(p_mods[i]))
+            goto exit;
+    }
+    // Freed handles are used again before the others
+    p_first = p_mods[0];
+    for (i = NUM_MODULES - 1; i >= 0; i --) {
+        udynlink_unload_module(p_mods[i]);
+        p_mods[i] = NULL;
+    }
+    if (udynlink_lookup_module("mod_pool0") != NULL) {
+        printf("Unloaded module found by name\n");
+        goto exit;
+    }
+    if ((p_mods[0] = udynlink_load_module(images[0], NULL, 0, mode, &err)) != p_first) {
+        printf("Freed handle not used again (error %d)\n", (int)err);
+        goto exit;
+    }
+    res = 1;
+exit:
+    for (i = NUM_MODULES - 1; i >= 0; i --) {
+        if (p_mods[i])
+            udynlink_unload_module(p_mods[i]);
+    }
+    return res;
+}
+
+int test_qemu(void) {
+    // Give the memory for the first handle before loading any module
+    if (udynlink_add_handle_memory(handle_mem, sizeof(handle_mem)) != MEM_HANDLES) {
+        printf("Unexpected number of handles in the given memory\n");
+        return 0;
+    }
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if (!run_test((udynlink_load_mode_t)i))
+            return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,11 @@
+#include <stdio.h>
+
+extern int host_add(int a, int b);
+extern int host_mul(int a, int b);
+extern int host_counter;
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_resolver");
+    host_counter ++;
+    return (host_add(2, 3) == 5) && (host_mul(2, 3) == 6) && (host_counter == 11);
+}
@@ -0,0 +1,9 @@
+# Resolve host symbols with a perfect hash resolver generated by mkmanifest
+# mkmanifest also checks that the host exports all the extern symbols of the module
+
+test_data = {
+    "desc": "Perfect hash host resolver",
+    "modules": [["mod_resolver.c"]],
+    "manifest_args": "--exports host_exports.txt --resolver ../qemu_host/src/host_resolver_data.h --resolver-name test_resolve_symbol --check mod_resolver.bin",
+    "required": ["Running test 'mod_resolver'"]
+}
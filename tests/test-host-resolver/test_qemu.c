@@ -0,0 +1,52 @@
+#include "udynlink.h"
+#include "mod_resolver_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+int host_counter = 10;
+
+int host_add(int a, int b) {
+    return a + b;
+}
+
+int host_mul(int a, int b) {
+    return a * b;
+}
+
+// Defines test_resolve_symbol (used by udynlink_external_resolve_symbol in main.c)
+#include "host_resolver_data.h"
+
+int test_qemu(void) {
+    const char *exported_syms[] = {"test", NULL};
+    const char *extern_syms[] = {"printf", "host_add", "host_mul", "host_counter", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((test_resolve_symbol("host_add") != (uint32_t)&host_add) || (test_resolve_symbol("host_counter") != (uint32_t)&host_counter)) {
+        printf("Unexpected resolver result\n");
+        return 0;
+    }
+    if ((test_resolve_symbol("host_sub") != 0) || (test_resolve_symbol("") != 0)) {
+        printf("Resolver found an unknown symbol\n");
+        return 0;
+    }
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        host_counter = 10;
+        if ((p_mod = udynlink_load_module(mod_resolver_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, 0);
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!check_extern_symbols(p_mod, extern_syms))
+            goto exit;
+        if (!run_test_func(p_mod))
+            goto exit;
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
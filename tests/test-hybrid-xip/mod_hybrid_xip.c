@@ -0,0 +1,32 @@
+// Module with a hot function listed in a profile (hot.txt), a function placed in .ramfunc with an attribute and cold code
+// that runs from flash in XIP mode
+
+#include <stdio.h>
+
+static int table[32];
+
+// Listed in hot.txt
+unsigned checksum(const int *p, int n) {
+    unsigned sum = 0;
+    for (int i = 0; i < n; i ++) {
+        sum = (sum << 1 | sum >> 31) ^ (unsigned)p[i];
+    }
+    return sum;
+}
+
+__attribute__((section(".ramfunc"))) int scale(int x) {
+    return x * 3;
+}
+
+void init_table(void) {
+    for (int i = 0; i < 32; i ++) {
+        table[i] = scale(i);
+    }
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_hybrid_xip");
+    init_table();
+    // Precomputed on the host for table[i] = 3 * i
+    return (table[31] == 93) && (checksum(table, 32) == 0xF7C57405u) && (checksum(table, 5) == 0x1Eu);
+}
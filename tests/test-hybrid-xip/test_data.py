@@ -0,0 +1,8 @@
+# Test hybrid XIP (hot functions copied to RAM, cold code executed in place)
+
+test_data = {
+    "desc": "Hybrid XIP",
+    "modules": [{"sources": ["mod_hybrid_xip.c"], "args": "--hot-functions hot.txt"}],
+    "required": ["Running test 'mod_hybrid_xip'"],
+    "total_loads": 2
+}
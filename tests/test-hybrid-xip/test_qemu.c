@@ -0,0 +1,44 @@
+#include "udynlink.h"
+#include "mod_hybrid_xip_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+static uint32_t module_ram[512];
+
+static int in_module_ram(uint32_t addr) {
+    return (addr >= (uint32_t)module_ram) && (addr < (uint32_t)module_ram + sizeof(module_ram));
+}
+
+static int run_test(udynlink_load_mode_t mode) {
+    const char *exported_syms[] = {"test", "checksum", "scale", "init_table", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module(mod_hybrid_xip_module_data, module_ram, sizeof(module_ram), mode, NULL)) == NULL)
+        return 0;
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    // The hot functions run from RAM in all the modes, the cold ones stay in flash in XIP mode
+    int xip = mode == UDYNLINK_LOAD_MODE_XIP;
+    if (!in_module_ram(udynlink_get_symbol_value(p_mod, "checksum")) || !in_module_ram(udynlink_get_symbol_value(p_mod, "scale"))) {
+        printf("Hot function not in RAM\n");
+        goto exit;
+    }
+    if ((in_module_ram(udynlink_get_symbol_value(p_mod, "init_table")) == xip) || (in_module_ram(udynlink_get_symbol_value(p_mod, "test")) == xip)) {
+        printf("Unexpected address of a cold function\n");
+        goto exit;
+    }
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    return run_test(UDYNLINK_LOAD_MODE_COPY_CODE) && run_test(UDYNLINK_LOAD_MODE_XIP);
+}
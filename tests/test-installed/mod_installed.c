@@ -0,0 +1,15 @@
+// Module with initialized data, pointers in data and bss
+
+#include <stdio.h>
+
+const char *names[2] = {"first", "second"};
+int counter = 5;
+int table[8];
+
+int test(void) {
+    printf("Running test '%s' (%s)\n", "mod_installed", names[1]);
+    for (int i = 0; i < 8; i ++) {
+        table[i] += i;
+    }
+    return (counter ++ == 5) && (table[7] == 7) && (names[0][0] == 'f');
+}
@@ -0,0 +1,8 @@
+# Test modules installed with their LOT in (simulated) flash
+
+test_data = {
+    "desc": "Installed modules",
+    "modules": [{"sources": ["mod_installed.c"]}, {"sources": ["mod_installed.c"], "args": "--relax-data --name mod_installed_relax"}],
+    "required": ["Running test 'mod_installed'"],
+    "total_loads": 2
+}
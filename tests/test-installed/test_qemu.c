@@ -0,0 +1,70 @@
+#include "udynlink.h"
+#include "mod_installed_module_data.h"
+#include "mod_installed_relax_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Simulated flash for the installed module (the test can't erase or program the real flash of the board)
+static uint32_t flash[256];
+static int flash_writes;
+// RAM for .data and .bss of the installed module
+static uint32_t module_ram[16];
+
+int test_flash_write(void *p_dst, const void *p_src, uint32_t size) {
+    if (((uint8_t*)p_dst < (uint8_t*)flash) || ((uint8_t*)p_dst + size > (uint8_t*)flash + sizeof(flash)))
+        return 0;
+    memcpy(p_dst, p_src, size);
+    flash_writes ++;
+    return 1;
+}
+
+static int run_test(void) {
+    const char *exported_syms[] = {"test", "names", "counter", "table", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_installed_module(flash, NULL)) == NULL)
+        return 0;
+    CHECK_RAM_SIZE(p_mod, 11 * sizeof(int));
+    // Only .data and .bss are in RAM
+    if ((p_mod->p_ram != module_ram) || (udynlink_get_ram_size(p_mod) != 11 * sizeof(int)) || (p_mod->lot_base < (uint32_t)flash) ||
+        (p_mod->lot_base >= (uint32_t)flash + sizeof(flash))) {
+        printf("Unexpected memory layout\n");
+        goto exit;
+    }
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    udynlink_error_t err;
+
+    if (udynlink_get_installed_size(mod_installed_module_data) > sizeof(flash)) {
+        printf("Not enough flash to install the module\n");
+        return 0;
+    }
+    if ((err = udynlink_install_module(mod_installed_module_data, flash, module_ram, sizeof(module_ram))) != UDYNLINK_OK) {
+        printf("Unable to install the module: %d\n", err);
+        return 0;
+    }
+    printf("Installed the module with %d flash write(s)\n", flash_writes);
+    // .data is restored from flash on each load
+    if (!run_test() || !run_test())
+        return 0;
+    // The data of modules built with --relax-data must follow the LOT
+    if ((err = udynlink_install_module(mod_installed_relax_module_data, flash, module_ram, sizeof(module_ram))) != UDYNLINK_ERR_INSTALL_UNSUPPORTED_MODULE) {
+        printf("Unexpected result %d when installing a module with relaxed data accesses\n", err);
+        return 0;
+    }
+    return 1;
+}
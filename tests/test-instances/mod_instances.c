@@ -0,0 +1,18 @@
+// Protocol handler with per-channel state (each channel uses its own instance of the module)
+
+#include <stdio.h>
+
+const char *proto_name = "proto";
+int received;
+int checksum = 1;
+
+int feed(int v) {
+    received ++;
+    checksum = checksum * 31 + v;
+    return received;
+}
+
+int test(void) {
+    printf("Running test '%s' (%s, %d bytes)\n", "mod_instances", proto_name, received);
+    return (received > 0) && (checksum != 1);
+}
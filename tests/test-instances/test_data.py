@@ -0,0 +1,8 @@
+# Test instances that share the code of a module
+
+test_data = {
+    "desc": "Module instances",
+    "modules": [{"sources": ["mod_instances.c"]}],
+    "required": ["Running test 'mod_instances'"],
+    "total_loads": 6
+}
@@ -0,0 +1,147 @@
+#include "udynlink.h"
+#include "mod_instances_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_CHANNELS        3
+
+// Return the number of LOT base lookups (made by the export wrappers) since the last reset
+static uint32_t get_lookups(void) {
+    uint32_t hits, misses;
+
+    udynlink_get_lot_base_stats(&hits, &misses);
+    return hits + misses;
+}
+
+// Feed "count" bytes to the given channel through its entry point
+static int feed_channel(udynlink_module_t *p_chan, int count) {
+    int (*p_feed)(int) = (int (*)(int))udynlink_get_instance_symbol(p_chan, "feed");
+    int res = 0;
+
+    for (int i = 0; i < count; i ++)
+        res = p_feed(i);
+    return res;
+}
+
+// Calls for different channels interleaved one by one through their entry points, which don't use the selected
+// instance (or look up the LOT base)
+static int interleave_channels(udynlink_module_t **p_chans) {
+    int (*p_feed[NUM_CHANNELS])(int);
+    uint32_t checksums[NUM_CHANNELS];
+    int i, round;
+
+    for (i = 0; i < NUM_CHANNELS; i ++) {
+        p_feed[i] = (int (*)(int))udynlink_get_instance_symbol(p_chans[i], "feed");
+        checksums[i] = *(uint32_t*)udynlink_get_instance_symbol(p_chans[i], "checksum");
+        if ((p_feed[i] == NULL) || ((i > 0) && (p_feed[i] == p_feed[i - 1])) || ((uint32_t)p_feed[i] != udynlink_get_instance_symbol(p_chans[i], "feed"))) {
+            printf("Unexpected entry point for channel %d\n", i);
+            return 0;
+        }
+    }
+    udynlink_select_instance(p_chans[0]);
+    udynlink_reset_lot_base_stats();
+    for (round = 1; round <= 4; round ++) {
+        for (i = NUM_CHANNELS - 1; i >= 0; i --) {
+            if (p_feed[i](100 * round + i) != 10 * (i + 1) + round) {
+                printf("Call for channel %d used another channel\n", i);
+                return 0;
+            }
+            checksums[i] = checksums[i] * 31 + (uint32_t)(100 * round + i);
+        }
+    }
+    if (get_lookups() != 0) {
+        printf("Entry points looked up the LOT base %u times\n", get_lookups());
+        return 0;
+    }
+    for (i = 0; i < NUM_CHANNELS; i ++) {
+        if (*(uint32_t*)udynlink_get_symbol_value(p_chans[i], "checksum") != checksums[i]) {
+            printf("Unexpected checksum in channel %d\n", i);
+            return 0;
+        }
+    }
+    // Calls through the exported symbols use the selected instance (the entry points didn't change it)
+    int (*p_feed_selected)(int) = (int (*)(int))udynlink_get_symbol_value(p_chans[0], "feed");
+    if ((udynlink_select_instance(p_chans[NUM_CHANNELS - 1]) != p_chans[0]) || (p_feed_selected(0) != 10 * NUM_CHANNELS + 5) ||
+        (*(int*)udynlink_get_symbol_value(p_chans[0], "received") != 14)) {
+        printf("Call through the exported symbol didn't use the selected channel\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int run_test(udynlink_load_mode_t mode) {
+    const char *exported_syms[] = {"test", "feed", "proto_name", "received", "checksum", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_chans[NUM_CHANNELS] = {NULL};
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    int res = 0, i;
+
+    if ((p_mod = udynlink_load_module(mod_instances_module_data, NULL, 0, mode, NULL)) == NULL)
+        return 0;
+    CHECK_RAM_SIZE(p_mod, 3 * sizeof(int));
+    // The module itself handles the first channel, the other channels are instances of it
+    p_chans[0] = p_mod;
+    for (i = 1; i < NUM_CHANNELS; i ++) {
+        if ((p_chans[i] = udynlink_create_instance(p_mod, NULL, 0, &err)) == NULL) {
+            printf("Unable to create instance %d: %d\n", i, err);
+            goto exit;
+        }
+        if (!check_exported_symbols(p_chans[i], exported_syms) || !check_extern_symbols(p_chans[i], extern_syms))
+            goto exit;
+        // Only the LOT, .data and .bss of an instance are in RAM and its functions are in the code of the module
+        if ((udynlink_get_ram_size(p_chans[i]) != p_mod->p_header->num_lot * sizeof(uint32_t) + 3 * sizeof(int)) ||
+            (udynlink_get_symbol_value(p_chans[i], "feed") != udynlink_get_symbol_value(p_mod, "feed"))) {
+            printf("Instance %d doesn't share the code of the module\n", i);
+            goto exit;
+        }
+    }
+    if (udynlink_unload_module(p_mod) != UDYNLINK_ERR_MODULE_IN_USE) {
+        printf("Module unloaded while it has instances\n");
+        goto exit;
+    }
+    // Each channel keeps its own state
+    for (i = 0; i < NUM_CHANNELS; i ++) {
+        if (feed_channel(p_chans[i], 10 * (i + 1)) != 10 * (i + 1)) {
+            printf("Unexpected state in channel %d\n", i);
+            goto exit;
+        }
+    }
+    for (i = 0; i < NUM_CHANNELS; i ++) {
+        if (*(int*)udynlink_get_symbol_value(p_chans[i], "received") != 10 * (i + 1)) {
+            printf("Channel %d received %d bytes\n", i, *(int*)udynlink_get_symbol_value(p_chans[i], "received"));
+            goto exit;
+        }
+        // run_test_func calls the exported symbol, so it needs the selection
+        udynlink_select_instance(p_chans[i]);
+        if (!run_test_func(p_chans[i]))
+            goto exit;
+    }
+    if (!interleave_channels(p_chans))
+        goto exit;
+    res = 1;
+exit:
+    for (i = NUM_CHANNELS - 1; i >= 0; i --) {
+        if (p_chans[i])
+            udynlink_unload_module(p_chans[i]);
+    }
+    return res;
+}
+
+int test_qemu(void) {
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    int res;
+
+    // The image isn't kept in COPY_ALL mode, so the instances can't get their initial .data
+    if ((p_mod = udynlink_load_module(mod_instances_module_data, NULL, 0, UDYNLINK_LOAD_MODE_COPY_ALL, NULL)) == NULL)
+        return 0;
+    res = (udynlink_create_instance(p_mod, NULL, 0, &err) == NULL) && (err == UDYNLINK_ERR_LOAD_INVALID_MODE);
+    udynlink_unload_module(p_mod);
+    if (!res) {
+        printf("Instance created in COPY_ALL mode\n");
+        return 0;
+    }
+    return run_test(UDYNLINK_LOAD_MODE_COPY_CODE) && run_test(UDYNLINK_LOAD_MODE_XIP);
+}
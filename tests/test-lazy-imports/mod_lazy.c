@@ -0,0 +1,17 @@
+// Module that calls extern functions through lazy binding stubs
+
+#include <stdio.h>
+
+extern int lazy_sum6(int a, int b, int c, int d, int e, int f);
+extern int lazy_unused(int x);
+
+// Never called by the test, so 'lazy_unused' is never bound
+int unused(void) {
+    return lazy_unused(1);
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_lazy");
+    // Six arguments, so that some are passed on the stack
+    return lazy_sum6(1, 2, 3, 4, 5, 6) == 21;
+}
@@ -0,0 +1,8 @@
+# Test extern functions bound on their first call
+
+test_data = {
+    "desc": "Lazy binding of extern functions",
+    "modules": [{"sources": ["mod_lazy.c"], "args": "--lazy-imports"}],
+    "required": ["Running test 'mod_lazy'"],
+    "total_loads": 6
+}
@@ -0,0 +1,64 @@
+#include "udynlink.h"
+#include "mod_lazy_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+static int sum6_resolves, unused_resolves;
+
+int lazy_sum6(int a, int b, int c, int d, int e, int f) {
+    return a + b + c + d + e + f;
+}
+
+int lazy_unused(int x) {
+    return x;
+}
+
+// Count how many times each lazy import is resolved (used by udynlink_external_resolve_symbol in main.c)
+uint32_t test_resolve_symbol(const char *name) {
+    if (!strcmp(name, "lazy_sum6")) {
+        sum6_resolves ++;
+        return (uint32_t)&lazy_sum6;
+    } else if (!strcmp(name, "lazy_unused")) {
+        unused_resolves ++;
+        return (uint32_t)&lazy_unused;
+    }
+    return 0;
+}
+
+int test_qemu(void) {
+    const char *exported_syms[] = {"test", "unused", NULL};
+    const char *extern_syms[] = {"printf", "lazy_sum6", "lazy_unused", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        sum6_resolves = unused_resolves = 0;
+        if ((p_mod = udynlink_load_module(mod_lazy_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, 0);
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!check_extern_symbols(p_mod, extern_syms))
+            goto exit;
+        // Nothing is bound when loading the module
+        if ((sum6_resolves != 0) || (unused_resolves != 0)) {
+            printf("Lazy imports resolved when loading the module\n");
+            goto exit;
+        }
+        // Only the first call binds the function
+        if (!run_test_func(p_mod) || !run_test_func(p_mod))
+            goto exit;
+        if ((sum6_resolves != 1) || (unused_resolves != 0)) {
+            printf("Unexpected number of resolves: %d, %d\n", sum6_resolves, unused_resolves);
+            goto exit;
+        }
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
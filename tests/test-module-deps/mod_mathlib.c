@@ -0,0 +1,15 @@
+// Library module, its exports are imported by mod_mathuser
+
+#include <stdio.h>
+
+int lib_calls;
+
+int lib_square(int x) {
+    lib_calls ++;
+    return x * x;
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_mathlib");
+    return lib_square(3) == 9;
+}
@@ -0,0 +1,13 @@
+// Module that imports a function and a variable from mod_mathlib
+
+#include <stdio.h>
+
+extern int lib_square(int x);
+extern int lib_calls;
+
+int test(void) {
+    int prev_calls = lib_calls;
+
+    printf("Running test '%s'\n", "mod_mathuser");
+    return (lib_square(4) == 16) && (lib_square(5) == 25) && (lib_calls == prev_calls + 2);
+}
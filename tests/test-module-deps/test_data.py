@@ -0,0 +1,7 @@
+# Test a module that imports symbols from another module
+
+test_data = {
+    "desc": "Inter-module imports",
+    "modules": [["mod_mathlib.c"], ["mod_mathuser.c"]],
+    "required": ["Running test 'mod_mathuser'"]
+}
@@ -0,0 +1,49 @@
+#include "udynlink.h"
+#include "mod_mathlib_module_data.h"
+#include "mod_mathuser_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+int test_qemu(void) {
+    // The user is listed first, udynlink_load_module_set must load the library before it
+    const void * const images[] = {mod_mathuser_module_data, mod_mathlib_module_data};
+    udynlink_module_t *p_mods[2] = {NULL, NULL};
+    udynlink_error_t err;
+    int res = 0;
+
+    // The user can't be loaded without the library
+    if ((udynlink_load_module(mod_mathuser_module_data, NULL, 0, UDYNLINK_LOAD_MODE_COPY_ALL, &err) != NULL) || (err != UDYNLINK_ERR_LOAD_UNKNOWN_SYMBOL)) {
+        printf("Module loaded without its dependency\n");
+        return 0;
+    }
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((err = udynlink_load_module_set(images, 2, (udynlink_load_mode_t)i, p_mods)) != UDYNLINK_OK) {
+            printf("Unable to load the module set (error %d)\n", (int)err);
+            return 0;
+        }
+        if ((p_mods[1]->ref_count != 1) || (p_mods[0]->num_deps != 1) || (p_mods[0]->p_deps[0] != p_mods[1])) {
+            printf("Unexpected dependency graph\n");
+            goto exit;
+        }
+        if (!run_test_func(p_mods[0]))
+            goto exit;
+        // The library is in use, so it can't be unloaded before the user
+        if (udynlink_unload_module(p_mods[1]) != UDYNLINK_ERR_MODULE_IN_USE) {
+            printf("Library unloaded while still in use\n");
+            goto exit;
+        }
+        if ((udynlink_unload_module(p_mods[0]) != UDYNLINK_OK) || (udynlink_unload_module(p_mods[1]) != UDYNLINK_OK)) {
+            printf("Unable to unload the module set\n");
+            p_mods[0] = p_mods[1] = NULL;
+            goto exit;
+        }
+        p_mods[0] = p_mods[1] = NULL;
+    }
+    res = 1;
+exit:
+    if (p_mods[0])
+        udynlink_unload_module(p_mods[0]);
+    if (p_mods[1])
+        udynlink_unload_module(p_mods[1]);
+    return res;
+}
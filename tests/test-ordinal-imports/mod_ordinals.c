@@ -0,0 +1,7 @@
+#include <stdio.h>
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_ordinals");
+    puts("Imported by ordinal");
+    return 1;
+}
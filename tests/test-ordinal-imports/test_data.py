@@ -0,0 +1,8 @@
+# Import host symbols by ordinal, using a host export manifest
+
+test_data = {
+    "desc": "Ordinal imports",
+    "manifest_args": "host_manifest.txt --output ../qemu_host/src/host_exports_data.h --check mod_ordinals.bin",
+    "modules": [{"sources": ["mod_ordinals.c"], "args": "--host-manifest host_manifest.txt"}],
+    "required": ["Running test 'mod_ordinals'", "Imported by ordinal"]
+}
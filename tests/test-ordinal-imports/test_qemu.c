@@ -0,0 +1,53 @@
+#include "udynlink.h"
+#include "mod_ordinals_module_data.h"
+#include "host_exports_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_HOST_EXPORTS                    (sizeof(host_exports) / sizeof(host_exports[0]))
+
+int test_qemu(void) {
+    const char *exported_syms[] = {"test", NULL};
+    udynlink_host_export_t bad_exports[NUM_HOST_EXPORTS];
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    udynlink_sym_t sym;
+    int res = 0;
+
+    udynlink_set_host_exports(host_exports, NUM_HOST_EXPORTS);
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((p_mod = udynlink_load_module(mod_ordinals_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, 0);
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        // The names of the imported symbols are not in the image
+        if (udynlink_lookup_symbol(p_mod, "printf", &sym) != NULL) {
+            printf("Found name of symbol imported by ordinal\n");
+            goto exit;
+        }
+        if (!run_test_func(p_mod))
+            goto exit;
+        udynlink_unload_module(p_mod);
+    }
+    p_mod = NULL;
+    // A host symbol with a different ABI must be rejected
+    memcpy(bad_exports, host_exports, sizeof(bad_exports));
+    bad_exports[2].hash ^= 1;
+    udynlink_set_host_exports(bad_exports, NUM_HOST_EXPORTS);
+    if ((p_mod = udynlink_load_module(mod_ordinals_module_data, NULL, 0, UDYNLINK_LOAD_MODE_XIP, &err)) != NULL) {
+        printf("Module loaded with a wrong host symbol hash\n");
+        goto exit;
+    }
+    if (err != UDYNLINK_ERR_LOAD_UNKNOWN_SYMBOL) {
+        printf("Unexpected error %d\n", (int)err);
+        goto exit;
+    }
+    res = 1;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    udynlink_set_host_exports(NULL, 0);
+    return res;
+}
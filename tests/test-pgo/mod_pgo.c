@@ -0,0 +1,43 @@
+// Control loop: a PI controller that drives a simulated first order plant to a setpoint. The fault handling and the
+// limits are rarely used, which the profile tells the compiler.
+
+#include <stdio.h>
+
+#define STEPS                               20000
+#define SETPOINT                            1000
+
+static int integral, output, faults;
+
+static int clamp(int x, int lo, int hi) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+static void on_fault(int err) {
+    faults ++;
+    integral = 0;
+    printf("Control error out of range: %d\n", err);
+}
+
+int control_step(int setpoint, int measured) {
+    int err = setpoint - measured;
+
+    if ((err > 100000) || (err < -100000)) {
+        on_fault(err);
+        return output;
+    }
+    integral = clamp(integral + err, -50000, 50000);
+    output = clamp((err * 12 + integral) >> 4, -4096, 4095);
+    return output;
+}
+
+int test(void) {
+    int plant = 0;
+
+    printf("Running test '%s'\n", "mod_pgo");
+    for (int i = 0; i < STEPS; i ++) {
+        int u = control_step(SETPOINT, plant);
+        plant += (u - (plant >> 3)) >> 3;
+    }
+    printf("Plant settled at %d after %d steps\n", plant, STEPS);
+    return (faults == 0) && (plant > SETPOINT - 10) && (plant < SETPOINT + 10);
+}
@@ -0,0 +1,12 @@
+# Profile-guided optimization: run the instrumented module, which writes its profile data through semihosting, then
+# rebuild it with the profile and run it again
+
+test_data = {
+    "desc": "Profile-guided optimization",
+    "modules": [{"sources": ["mod_pgo.c"], "args": "--profile-generate"}],
+    "rebuild": [{"sources": ["mod_pgo.c"], "args": "--profile-use"}],
+    "required": ["Running test 'mod_pgo'", "Plant settled at"],
+    "rebuild_required": ["optimized with the profile"],
+    "libs": "-lgcov",
+    "total_loads": 1
+}
@@ -0,0 +1,81 @@
+#include "udynlink.h"
+#include "mod_pgo_module_data.h"
+#include "test_utils.h"
+#include <gcov.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// libgcov symbols used by instrumented modules (GCC 12). mkmodule disables value profiling, so the modules only have
+// edge counters, which are merged with __gcov_merge_add.
+extern uint8_t __gcov_merge_add[];
+
+static const struct {
+    const char *name;
+    const void *addr;
+} gcov_syms[] = {
+    {"__gcov_merge_add", __gcov_merge_add}
+};
+
+uint32_t test_resolve_symbol(const char *name) {
+    for (unsigned i = 0; i < sizeof(gcov_syms) / sizeof(gcov_syms[0]); i ++) {
+        if (!strcmp(name, gcov_syms[i].name))
+            return (uint32_t)gcov_syms[i].addr;
+    }
+    return 0;
+}
+
+// The profile data of each object of the module is written to its .gcda file on the host, through semihosting
+static void gcda_open(const char *name, void *arg) {
+    *(FILE**)arg = fopen(name, "wb");
+}
+
+static void gcda_write(const void *p_data, unsigned size, void *arg) {
+    if (*(FILE**)arg)
+        fwrite(p_data, 1, size, *(FILE**)arg);
+}
+
+static void *gcda_alloc(unsigned size, void *arg) {
+    (void)arg;
+    return malloc(size);
+}
+
+static int write_profile(udynlink_module_t *p_mod) {
+    const struct gcov_info **p_start = (const struct gcov_info **)udynlink_get_symbol_value(p_mod, "__udynlink_gcov_info_start");
+    const struct gcov_info **p_end = (const struct gcov_info **)udynlink_get_symbol_value(p_mod, "__udynlink_gcov_info_end");
+
+    for (const struct gcov_info **p = p_start; p < p_end; p ++) {
+        FILE *f = NULL;
+        __gcov_info_to_gcda(*p, gcda_open, gcda_write, gcda_alloc, &f);
+        if (f == NULL) {
+            printf("Unable to write the profile data\n");
+            return 0;
+        }
+        fclose(f);
+    }
+    printf("Profile data written for %d object(s)\n", (int)(p_end - p_start));
+    return p_end > p_start;
+}
+
+int test_qemu(void) {
+    udynlink_module_t *p_mod;
+    udynlink_sym_t sym;
+    uint32_t start;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module(mod_pgo_module_data, NULL, 0, UDYNLINK_LOAD_MODE_COPY_CODE, NULL)) == NULL)
+        return 0;
+    // The instrumented module (first stage) exports the list of its profile data
+    int instrumented = udynlink_lookup_symbol(p_mod, "__udynlink_gcov_info_start", &sym) != NULL;
+    start = get_ms_ticks();
+    if (!run_test_func(p_mod))
+        goto exit;
+    start = get_ms_ticks() - start;
+    printf("Control loop took %u ms (%s)\n", start, instrumented ? "instrumented" : "optimized with the profile");
+    if (instrumented && !write_profile(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
@@ -0,0 +1,16 @@
+// Module with a large buffer in .bss, a variable in .fastdata and pointers in .data
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *msg = "placement";
+int scale __attribute__((section(".fastdata"))) = 3;
+int samples[256];
+
+int test(void) {
+    printf("Running test '%s' (%s)\n", "mod_placement", msg);
+    for (int i = 0; i < 256; i ++) {
+        samples[i] = i * scale;
+    }
+    return (samples[255] == 765) && !strcmp(msg, "placement");
+}
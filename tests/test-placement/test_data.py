@@ -0,0 +1,8 @@
+# Test modules with their LOT, data and code placed in different RAM regions
+
+test_data = {
+    "desc": "Segment placement",
+    "modules": [{"sources": ["mod_placement.c"]}, {"sources": ["mod_placement.c"], "args": "--relax-data --name mod_placement_relax"}],
+    "required": ["Running test 'mod_placement'"],
+    "total_loads": 4
+}
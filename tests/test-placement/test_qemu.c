@@ -0,0 +1,110 @@
+#include "udynlink.h"
+#include "mod_placement_module_data.h"
+#include "mod_placement_relax_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// A simple allocator for a RAM region: memory is allocated from the start of the region and freed all at once
+typedef struct {
+    uint8_t *p_start;
+    uint32_t size;
+    uint32_t used;
+    int allocs;
+} region_state_t;
+
+// CCM RAM (not used by the test host) for the LOT and a static buffer that stands for an external SDRAM
+static uint32_t sdram[512];
+static region_state_t ccm_state = {(uint8_t*)0x10000000, 64 * 1024, 0, 0};
+static region_state_t sdram_state = {(uint8_t*)sdram, sizeof(sdram), 0, 0};
+
+static void *region_alloc(void *p_ctx, uint32_t size) {
+    region_state_t *p_state = (region_state_t*)p_ctx;
+    void *p_mem = p_state->p_start + p_state->used;
+
+    if (p_state->used + size > p_state->size)
+        return NULL;
+    p_state->used += (size + 7) & ~7u;
+    p_state->allocs ++;
+    return p_mem;
+}
+
+static void region_free(void *p_ctx, void *p_mem) {
+    region_state_t *p_state = (region_state_t*)p_ctx;
+
+    (void)p_mem;
+    if (-- p_state->allocs == 0)
+        p_state->used = 0;
+}
+
+static const udynlink_region_t ccm = {region_alloc, region_free, &ccm_state};
+static const udynlink_region_t ext_sdram = {region_alloc, region_free, &sdram_state};
+// LOT in CCM, .data and .bss in the external SDRAM, code allocated with udynlink_external_malloc
+static const udynlink_region_t * const placement[UDYNLINK_NUM_SEGMENTS] = {&ccm, &ext_sdram, NULL};
+
+static int in_region(const region_state_t *p_state, const void *p) {
+    return ((const uint8_t*)p >= p_state->p_start) && ((const uint8_t*)p < p_state->p_start + p_state->size);
+}
+
+static int run_test(const unsigned char *p_image, udynlink_load_mode_t mode, int r9_data) {
+    const char *exported_syms[] = {"test", "scale", "samples", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module_placed(p_image, placement, mode, NULL)) == NULL)
+        return 0;
+    CHECK_RAM_SIZE(p_mod, 258 * sizeof(int));
+    // Modules that access their data relative to r9 keep it after the LOT
+    if (!in_region(&ccm_state, (void*)p_mod->lot_base) || !in_region(r9_data ? &ccm_state : &sdram_state, (void*)udynlink_get_symbol_value(p_mod, "samples"))) {
+        printf("Unexpected placement of the segments\n");
+        goto exit;
+    }
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    if ((ccm_state.used != 0) || (sdram_state.used != 0)) {
+        printf("Segments not freed\n");
+        res = 0;
+    }
+    return res;
+}
+
+// A module that doesn't fit in its regions isn't loaded, and the segments that were allocated before the failure are
+// freed. The data segment of mod_placement holds .data without .fastdata (which follows the LOT).
+static int run_test_out_of_memory(void) {
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    uint32_t size = sdram_state.size;
+
+    sdram_state.size = 64;
+    p_mod = udynlink_load_module_placed(mod_placement_module_data, placement, UDYNLINK_LOAD_MODE_COPY_CODE, &err);
+    sdram_state.size = size;
+    if ((p_mod != NULL) || (err != UDYNLINK_ERR_LOAD_OUT_OF_MEMORY)) {
+        printf("Module loaded in a region that is too small\n");
+        if (p_mod != NULL)
+            udynlink_unload_module(p_mod);
+        return 0;
+    }
+    if ((ccm_state.used != 0) || (ccm_state.allocs != 0) || (sdram_state.used != 0) || (sdram_state.allocs != 0)) {
+        printf("Segments not freed\n");
+        return 0;
+    }
+    return 1;
+}
+
+int test_qemu(void) {
+    for (int i = (int)UDYNLINK_LOAD_MODE_COPY_ALL; i <= (int)UDYNLINK_LOAD_MODE_XIP; i ++) {
+        if (!run_test(mod_placement_module_data, (udynlink_load_mode_t)i, 0))
+            return 0;
+    }
+    if (!run_test(mod_placement_relax_module_data, UDYNLINK_LOAD_MODE_COPY_CODE, 1))
+        return 0;
+    return run_test_out_of_memory();
+}
@@ -0,0 +1,20 @@
+// Module with relocations in the LOT and in .data
+
+#include <stdio.h>
+
+static int twice(int x) {
+    return 2 * x;
+}
+
+static int square(int x) {
+    return x * x;
+}
+
+int values[4] = {1, 2, 3, 4};
+int (*ops[2])(int) = {twice, square};
+int *p_last = &values[3];
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_prelink");
+    return (ops[0](values[1]) == 4) && (ops[1](*p_last) == 16);
+}
@@ -0,0 +1,9 @@
+# Test modules prelinked for a fixed RAM address (the CCM RAM, which isn't used by the test host)
+
+test_data = {
+    "desc": "Prelinked modules",
+    "modules": [{"sources": ["mod_prelink.c"], "args": "--prelink 0x10000000"},
+                {"sources": ["mod_prelink.c"], "args": "--prelink 0x10000000 --prelink-mode copy_all --name mod_prelink_all"}],
+    "required": ["Running test 'mod_prelink'", "Module is prelinked for this address"],
+    "total_loads": 2
+}
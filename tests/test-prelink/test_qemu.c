@@ -0,0 +1,47 @@
+#include "udynlink.h"
+#include "mod_prelink_module_data.h"
+#include "mod_prelink_all_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// The modules are prelinked for this address (CCM RAM)
+#define PRELINK_RAM_ADDR                    ((void*)0x10000000)
+#define PRELINK_RAM_SIZE                    (64 * 1024)
+
+static int run_test(const unsigned char *p_image, void *load_addr, udynlink_load_mode_t mode) {
+    const char *exported_syms[] = {"test", "values", "ops", "p_last", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module(p_image, load_addr, load_addr ? PRELINK_RAM_SIZE : 0, mode, NULL)) == NULL)
+        return 0;
+    CHECK_RAM_SIZE(p_mod, 7 * sizeof(int));
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    // At the address and in the load mode used for prelinking, only the extern symbols are relocated
+    if (!run_test(mod_prelink_module_data, PRELINK_RAM_ADDR, UDYNLINK_LOAD_MODE_COPY_CODE))
+        return 0;
+    if (!run_test(mod_prelink_all_module_data, PRELINK_RAM_ADDR, UDYNLINK_LOAD_MODE_COPY_ALL))
+        return 0;
+    // Anywhere else, the modules are relocated as usual
+    if (!run_test(mod_prelink_module_data, NULL, UDYNLINK_LOAD_MODE_COPY_CODE))
+        return 0;
+    if (!run_test(mod_prelink_module_data, PRELINK_RAM_ADDR, UDYNLINK_LOAD_MODE_COPY_ALL))
+        return 0;
+    if (!run_test(mod_prelink_all_module_data, NULL, UDYNLINK_LOAD_MODE_XIP))
+        return 0;
+    return 1;
+}
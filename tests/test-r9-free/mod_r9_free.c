@@ -0,0 +1,32 @@
+// Module with public functions that don't depend on r9 (exported without a wrapper) and functions that do
+
+#include <stdio.h>
+
+int counter;
+
+// Doesn't access global data or call other functions, so it doesn't use r9
+int add3(int a, int b, int c) {
+    return a + b + c;
+}
+
+// Calls only a function that doesn't use r9
+int add3_twice(int a, int b, int c) {
+    return add3(a, b, c) + add3(a, b, c);
+}
+
+// Accesses a global variable through the LOT (r9)
+int bump(int v) {
+    counter += v;
+    return counter;
+}
+
+// Doesn't use r9 itself, but calls a function that does
+int bump_twice(int v) {
+    bump(v);
+    return bump(v);
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_r9_free");
+    return (add3_twice(1, 2, 3) == 12) && (bump_twice(1) == counter);
+}
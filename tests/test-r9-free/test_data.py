@@ -0,0 +1,7 @@
+# Test the public functions that are exported without a wrapper, because they don't depend on r9
+
+test_data = {
+    "desc": "Exports without a wrapper",
+    "modules": [["mod_r9_free.c"]],
+    "required": ["Running test 'mod_r9_free'"]
+}
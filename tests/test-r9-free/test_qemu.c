@@ -0,0 +1,57 @@
+#include "udynlink.h"
+#include "mod_r9_free_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+// Return the number of LOT base lookups (made by the export wrappers) since the last reset
+static uint32_t get_lookups(void) {
+    uint32_t hits, misses;
+
+    udynlink_get_lot_base_stats(&hits, &misses);
+    return hits + misses;
+}
+
+int test_qemu(void) {
+    const char *exported_syms[] = {"test", "add3", "add3_twice", "bump", "bump_twice", "counter", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((p_mod = udynlink_load_module(mod_r9_free_module_data, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, sizeof(int));
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!check_extern_symbols(p_mod, extern_syms))
+            goto exit;
+        int (*p_add3)(int, int, int) = (int (*)(int, int, int))udynlink_get_symbol_value(p_mod, "add3");
+        int (*p_add3_twice)(int, int, int) = (int (*)(int, int, int))udynlink_get_symbol_value(p_mod, "add3_twice");
+        int (*p_bump)(int) = (int (*)(int))udynlink_get_symbol_value(p_mod, "bump");
+        int (*p_bump_twice)(int) = (int (*)(int))udynlink_get_symbol_value(p_mod, "bump_twice");
+        // The functions that don't depend on r9 are called directly, so they don't look up the LOT base
+        udynlink_reset_lot_base_stats();
+        if ((p_add3(1, 2, 3) != 6) || (p_add3_twice(1, 2, 3) != 12) || (get_lookups() != 0)) {
+            printf("Function without an r9 dependency called through a wrapper (%u lookups)\n", get_lookups());
+            goto exit;
+        }
+        // The other functions keep their wrapper, which looks up the LOT base once per call from the outside
+        if ((p_bump(2) != 2) || (get_lookups() != 1) || (p_bump_twice(3) != 8) || (get_lookups() != 2)) {
+            printf("Function that depends on r9 called without a wrapper (%u lookups)\n", get_lookups());
+            goto exit;
+        }
+        if (*(int*)udynlink_get_symbol_value(p_mod, "counter") != 8) {
+            printf("Unexpected counter value\n");
+            goto exit;
+        }
+        if (!run_test_func(p_mod))
+            goto exit;
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
@@ -0,0 +1,11 @@
+// Mutually recursive public functions implemented in different source files.
+// Both functions update a global, so they depend on r9 and have export wrappers.
+
+extern int fib_b(int n);
+
+int calls;
+
+int fib_a(int n) {
+    calls ++;
+    return n < 2 ? n : fib_b(n - 1) + fib_b(n - 2);
+}
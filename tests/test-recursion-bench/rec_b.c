@@ -0,0 +1,7 @@
+extern int fib_a(int n);
+extern int calls;
+
+int fib_b(int n) {
+    calls ++;
+    return n < 2 ? n : fib_a(n - 1) + fib_a(n - 2);
+}
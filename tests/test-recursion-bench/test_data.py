@@ -0,0 +1,8 @@
+# Benchmark recursive calls between public functions of a module, with and without wrappers on internal calls
+
+test_data = {
+    "desc": "Recursion benchmark for internal calls",
+    "modules": [["mod_rec_bench.c", "rec_b.c"], {"sources": ["mod_rec_bench.c", "rec_b.c"], "args": "--wrap-internal-calls --name mod_rec_bench_wrapped"}],
+    "required": ["fib\\(20\\) took"],
+    "total_loads": 6
+}
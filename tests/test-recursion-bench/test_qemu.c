@@ -0,0 +1,55 @@
+#include "udynlink.h"
+#include "udynlink_externals.h"
+#include "mod_rec_bench_module_data.h"
+#include "mod_rec_bench_wrapped_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FIB_ARG                             20
+#define FIB_RESULT                          6765
+#define FIB_CALLS                           21891
+
+// Run fib_a(FIB_ARG) in the given module and return the number of LOT base lookups done by the export wrappers
+static int run_bench(const unsigned char *p_image, const char *desc, uint32_t *p_lookups) {
+    udynlink_module_t *p_mod;
+    uint32_t hits, misses, start;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((p_mod = udynlink_load_module(p_image, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, sizeof(int));
+        int (*p_fib)(int) = (int (*)(int))udynlink_get_symbol_value(p_mod, "fib_a");
+        udynlink_reset_lot_base_stats();
+        start = get_ms_ticks();
+        int fib = p_fib(FIB_ARG);
+        start = get_ms_ticks() - start;
+        udynlink_get_lot_base_stats(&hits, &misses);
+        printf("%s: fib(%d) took %u ms in load mode %d, %u LOT base lookups\n", desc, FIB_ARG, start, i, hits + misses);
+        if ((fib != FIB_RESULT) || (*(int*)udynlink_get_symbol_value(p_mod, "calls") != FIB_CALLS)) {
+            printf("Unexpected result\n");
+            goto exit;
+        }
+        *p_lookups = hits + misses;
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    uint32_t lookups;
+
+    // Internal calls bind to the function bodies, so only the call from the host goes through a wrapper
+    if (!run_bench(mod_rec_bench_module_data, "direct internal calls", &lookups) || (lookups != 1))
+        return 0;
+    // Every call goes through a wrapper
+    if (!run_bench(mod_rec_bench_wrapped_module_data, "wrapped internal calls", &lookups) || (lookups != FIB_CALLS))
+        return 0;
+    return 1;
+}
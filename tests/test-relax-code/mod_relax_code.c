@@ -0,0 +1,22 @@
+#include <stdio.h>
+
+static const int squares[] = {0, 1, 4, 9, 16, 25};
+
+static int twice(int x) {
+    return 2 * x;
+}
+
+static int square(int x) {
+    return squares[x];
+}
+
+int apply(int op, int x) {
+    int (* volatile p_func)(int) = op ? square : twice;
+
+    return p_func(x) + squares[x];
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_relax_code");
+    return (apply(0, 3) == 15) && (apply(1, 5) == 50);
+}
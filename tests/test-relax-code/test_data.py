@@ -0,0 +1,9 @@
+# Compute the addresses of functions and read-only data relative to PC instead of loading them from the LOT
+# The same module is also built without relaxation, to compare the number of LOT entries
+
+test_data = {
+    "desc": "Relaxed code accesses",
+    "modules": [{"sources": ["mod_relax_code.c"], "args": "--relax-code"}, {"sources": ["mod_relax_code.c"], "args": "--name mod_relax_code_lot"}],
+    "required": ["Running test 'mod_relax_code'"],
+    "total_loads": 6
+}
@@ -0,0 +1,39 @@
+#include "udynlink.h"
+#include "mod_relax_code_module_data.h"
+#include "mod_relax_code_lot_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+static int test_image(const unsigned char *p_image) {
+    const char *exported_syms[] = {"test", "apply", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((p_mod = udynlink_load_module(p_image, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, 0);
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!run_test_func(p_mod))
+            goto exit;
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    const udynlink_module_header_t *p_relaxed = (const udynlink_module_header_t*)mod_relax_code_module_data;
+    const udynlink_module_header_t *p_lot = (const udynlink_module_header_t*)mod_relax_code_lot_module_data;
+
+    if (!test_image(mod_relax_code_module_data) || !test_image(mod_relax_code_lot_module_data))
+        return 0;
+    // Relaxed code accesses don't need LOT entries
+    printf("LOT entries: %u (relaxed), %u (not relaxed)\n", p_relaxed->num_lot, p_lot->num_lot);
+    return p_relaxed->num_lot < p_lot->num_lot;
+}
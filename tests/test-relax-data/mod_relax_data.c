@@ -0,0 +1,16 @@
+#include <stdio.h>
+
+volatile int g = 50;
+volatile static int g2 = 30;
+int table[4];
+static int counter;
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_relax_data");
+    g += 10;
+    g2 += 20;
+    for (int i = 0; i < 4; i ++)
+        table[i] = i * g2;
+    counter ++;
+    return (g == 60) && (g2 == 50) && (table[3] == 150) && (counter == 1);
+}
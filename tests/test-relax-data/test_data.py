@@ -0,0 +1,9 @@
+# Access module data relative to r9 instead of through the LOT
+# The same module is also built without relaxation, to compare the number of LOT entries
+
+test_data = {
+    "desc": "Relaxed data accesses",
+    "modules": [{"sources": ["mod_relax_data.c"], "args": "--relax-data"}, {"sources": ["mod_relax_data.c"], "args": "--name mod_relax_data_lot"}],
+    "required": ["Running test 'mod_relax_data'"],
+    "total_loads": 6
+}
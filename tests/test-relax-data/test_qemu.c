@@ -0,0 +1,47 @@
+#include "udynlink.h"
+#include "mod_relax_data_module_data.h"
+#include "mod_relax_data_lot_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+
+#define EXPECTED_G_VAL                      60
+
+static int test_image(const unsigned char *p_image) {
+    const char *exported_syms[] = {"test", "g", "table", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((p_mod = udynlink_load_module(p_image, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, 7 * sizeof(int));
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!run_test_func(p_mod))
+            goto exit;
+        // Check the expected value of the global variable
+        uint32_t v = *(int*)udynlink_get_symbol_value(p_mod, "g");
+        if (v != EXPECTED_G_VAL) {
+            printf("Unexpected value %d for variable 'g', expected %d\n", v, EXPECTED_G_VAL);
+            goto exit;
+        }
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    const udynlink_module_header_t *p_relaxed = (const udynlink_module_header_t*)mod_relax_data_module_data;
+    const udynlink_module_header_t *p_lot = (const udynlink_module_header_t*)mod_relax_data_lot_module_data;
+
+    if (!test_image(mod_relax_data_module_data) || !test_image(mod_relax_data_lot_module_data))
+        return 0;
+    // Relaxed data accesses don't need LOT entries
+    printf("LOT entries: %u (relaxed), %u (not relaxed)\n", p_relaxed->num_lot, p_lot->num_lot);
+    return p_relaxed->num_lot < p_lot->num_lot;
+}
@@ -0,0 +1,23 @@
+// Module with a function in .ramfunc, a variable in .fastdata and a counter in .noinit
+
+#include <stdio.h>
+
+int gain __attribute__((section(".fastdata"))) = 5;
+int boots __attribute__((section(".noinit")));
+int history[16];
+
+__attribute__((section(".ramfunc"))) int filter(int x) {
+    return x * gain;
+}
+
+int (*p_filter)(int) = filter;
+int *p_gain = &gain;
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_sections");
+    for (int i = 0; i < 16; i ++) {
+        history[i] = p_filter(i);
+    }
+    boots ++;
+    return (history[15] == 75) && (filter(2) == 10) && (*p_gain == 5);
+}
@@ -0,0 +1,8 @@
+# Test .ramfunc, .fastdata and .noinit sections
+
+test_data = {
+    "desc": "Sections with their own placement",
+    "modules": [{"sources": ["mod_sections.c"]}],
+    "required": ["Running test 'mod_sections'"],
+    "total_loads": 6
+}
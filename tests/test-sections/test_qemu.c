@@ -0,0 +1,125 @@
+#include "udynlink.h"
+#include "mod_sections_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// The module is always loaded at the same address, so that .noinit keeps its content between loads
+static uint32_t module_ram[1024];
+
+static int in_module_ram(uint32_t addr) {
+    return (addr >= (uint32_t)module_ram) && (addr < (uint32_t)module_ram + sizeof(module_ram));
+}
+
+// Regions for udynlink_load_module_placed: each one holds a single segment
+typedef struct {
+    uint32_t *p_mem;
+    uint32_t size;
+    int used;
+} region_state_t;
+
+static uint32_t fast_ram[64], slow_ram[64];
+static region_state_t fast_state = {fast_ram, sizeof(fast_ram), 0};
+static region_state_t slow_state = {slow_ram, sizeof(slow_ram), 0};
+
+static void *region_alloc(void *p_ctx, uint32_t size) {
+    region_state_t *p_state = (region_state_t*)p_ctx;
+
+    if (p_state->used || (size > p_state->size))
+        return NULL;
+    p_state->used = 1;
+    return p_state->p_mem;
+}
+
+static void region_free(void *p_ctx, void *p_mem) {
+    region_state_t *p_state = (region_state_t*)p_ctx;
+
+    if (p_mem == p_state->p_mem)
+        p_state->used = 0;
+}
+
+static const udynlink_region_t fast = {region_alloc, region_free, &fast_state};
+static const udynlink_region_t slow = {region_alloc, region_free, &slow_state};
+// LOT and .fastdata in the fast region, the rest of .data and .bss in the slow one, code allocated with udynlink_external_malloc
+static const udynlink_region_t * const placement[UDYNLINK_NUM_SEGMENTS] = {&fast, &slow, NULL};
+
+static int in_region(const region_state_t *p_state, uint32_t addr) {
+    return (addr >= (uint32_t)p_state->p_mem) && (addr < (uint32_t)p_state->p_mem + p_state->size);
+}
+
+static int run_test(udynlink_load_mode_t mode, int load) {
+    const char *exported_syms[] = {"test", "filter", "gain", "boots", "history", "p_filter", "p_gain", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module(mod_sections_module_data, module_ram, sizeof(module_ram), mode, NULL)) == NULL)
+        return 0;
+    CHECK_RAM_SIZE(p_mod, 20 * sizeof(int));
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    // .ramfunc runs from RAM in all the modes, the rest of the code stays in flash in XIP mode
+    if (!in_module_ram(udynlink_get_symbol_value(p_mod, "filter")) || (in_module_ram(udynlink_get_symbol_value(p_mod, "test")) == (mode == UDYNLINK_LOAD_MODE_XIP))) {
+        printf("Unexpected address of the code\n");
+        goto exit;
+    }
+    // .fastdata is initialized on each load, .noinit is not
+    int *p_boots = (int*)udynlink_get_symbol_value(p_mod, "boots");
+    if (load == 0) {
+        *p_boots = 0;
+    }
+    if ((*(int*)udynlink_get_symbol_value(p_mod, "gain") != 5) || (*p_boots != load)) {
+        printf("Unexpected initial data\n");
+        goto exit;
+    }
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    return res;
+}
+
+// With placed segments, .fastdata is split from the rest of .data and follows the LOT
+static int run_test_placed(udynlink_load_mode_t mode) {
+    const char *exported_syms[] = {"test", "filter", "gain", "boots", "history", "p_filter", "p_gain", NULL};
+    udynlink_module_t *p_mod;
+    int res = 0;
+
+    if ((p_mod = udynlink_load_module_placed(mod_sections_module_data, placement, mode, NULL)) == NULL)
+        return 0;
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    uint32_t gain = udynlink_get_symbol_value(p_mod, "gain"), p_gain = udynlink_get_symbol_value(p_mod, "p_gain");
+    if (!in_region(&fast_state, p_mod->lot_base) || !in_region(&fast_state, gain) || !in_region(&slow_state, p_gain) || !in_region(&slow_state, udynlink_get_symbol_value(p_mod, "history"))) {
+        printf("Unexpected placement of the data\n");
+        goto exit;
+    }
+    // .fastdata is initialized and the pointer to it in .data is relocated to its new place
+    if ((*(int*)gain != 5) || (*(uint32_t*)p_gain != gain)) {
+        printf("Unexpected initial data\n");
+        goto exit;
+    }
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    udynlink_unload_module(p_mod);
+    if (fast_state.used || slow_state.used) {
+        printf("Segments not freed\n");
+        res = 0;
+    }
+    return res;
+}
+
+int test_qemu(void) {
+    for (int i = (int)UDYNLINK_LOAD_MODE_COPY_CODE; i <= (int)UDYNLINK_LOAD_MODE_XIP; i ++) {
+        for (int load = 0; load < 2; load ++) {
+            if (!run_test((udynlink_load_mode_t)i, load))
+                return 0;
+        }
+    }
+    return run_test_placed(UDYNLINK_LOAD_MODE_COPY_CODE) && run_test_placed(UDYNLINK_LOAD_MODE_XIP);
+}
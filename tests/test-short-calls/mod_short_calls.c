@@ -0,0 +1,23 @@
+#include <stdio.h>
+
+static int square(int x) {
+    return x * x;
+}
+
+int sum_squares(int n) {
+    int s = 0;
+
+    for (int i = 1; i <= n; i ++)
+        s += square(i);
+    return s;
+}
+
+// With optimizations, this is a tail call (B.W) to an extern function
+int report(int v) {
+    return printf("Sum of squares is %d\n", v);
+}
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_short_calls");
+    return report(sum_squares(4)) > 0 && sum_squares(4) == 30;
+}
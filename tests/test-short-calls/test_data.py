@@ -0,0 +1,7 @@
+# Test short calls inside a module, with extern functions called through veneers
+
+test_data = {
+    "desc": "Short calls and extern veneers",
+    "modules": [{"sources": ["mod_short_calls.c"], "args": "--short-calls"}],
+    "required": ["Running test 'mod_short_calls'", "Sum of squares is 30"]
+}
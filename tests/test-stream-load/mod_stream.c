@@ -0,0 +1,16 @@
+// Module with code, data and bss, loaded through a read function
+
+#include <stdio.h>
+
+int counter = 10;
+int zeroes[16];
+
+int test(void) {
+    int sum = 0;
+
+    printf("Running test '%s'\n", "mod_stream");
+    for (int i = 0; i < 16; i ++) {
+        sum += zeroes[i];
+    }
+    return (sum == 0) && (counter ++ == 10);
+}
@@ -0,0 +1,8 @@
+# Test loading module images through a read function
+
+test_data = {
+    "desc": "Streamed module images",
+    "modules": [{"sources": ["mod_stream.c"]}, {"sources": ["mod_stream.c"], "args": "--compress --name mod_stream_compressed"}],
+    "required": ["Running test 'mod_stream'"],
+    "total_loads": 2
+}
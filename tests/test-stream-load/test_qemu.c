@@ -0,0 +1,67 @@
+#include "udynlink.h"
+#include "mod_stream_module_data.h"
+#include "mod_stream_compressed_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Image that is read in order, like a file on an SD card or a module received over a serial port
+typedef struct {
+    const unsigned char *p_data;
+    uint32_t size;
+    uint32_t offset;
+} stream_t;
+
+static int read_image(void *p_ctx, void *p_buf, uint32_t size) {
+    stream_t *p_stream = (stream_t*)p_ctx;
+
+    if (p_stream->offset + size > p_stream->size)
+        return 0;
+    memcpy(p_buf, p_stream->p_data + p_stream->offset, size);
+    p_stream->offset += size;
+    return 1;
+}
+
+static int run_test(const unsigned char *p_image, uint32_t size) {
+    const char *exported_syms[] = {"test", "counter", "zeroes", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    stream_t stream = {p_image, size, 0};
+    udynlink_module_t *p_mod;
+    udynlink_error_t err;
+    int res = 0;
+
+    // A truncated image can't be loaded
+    stream.size = size - 1;
+    if ((p_mod = udynlink_load_module_stream(read_image, &stream, NULL, 0, &err)) != NULL || (err != UDYNLINK_ERR_LOAD_READ_ERROR)) {
+        printf("Truncated image loaded\n");
+        goto exit;
+    }
+    stream.size = size;
+    stream.offset = 0;
+    if ((p_mod = udynlink_load_module_stream(read_image, &stream, NULL, 0, NULL)) == NULL)
+        return 0;
+    if (stream.offset != size) {
+        printf("Read %u bytes of the image instead of %u\n", stream.offset, size);
+        goto exit;
+    }
+    CHECK_RAM_SIZE(p_mod, 17 * sizeof(int));
+    if (!check_exported_symbols(p_mod, exported_syms))
+        goto exit;
+    if (!check_extern_symbols(p_mod, extern_syms))
+        goto exit;
+    if (!run_test_func(p_mod))
+        goto exit;
+    res = 1;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    if (!run_test(mod_stream_module_data, sizeof(mod_stream_module_data)))
+        return 0;
+    if (!run_test(mod_stream_compressed_module_data, sizeof(mod_stream_compressed_module_data)))
+        return 0;
+    return 1;
+}
@@ -0,0 +1,21 @@
+// Module with a larger number of exported symbols, used to test symbol lookups
+
+#include <stdio.h>
+
+int v0 = 0, v1 = 1, v2 = 2, v3 = 3;
+
+int f0(void) { return 0; }
+int f1(void) { return 1; }
+int f2(void) { return 2; }
+int f3(void) { return 3; }
+int f4(void) { return 4; }
+int f5(void) { return 5; }
+int f6(void) { return 6; }
+int f7(void) { return 7; }
+int f8(void) { return 8; }
+int f9(void) { return 9; }
+
+int test(void) {
+    printf("Running test '%s'\n", "mod_sym_hash");
+    return v0 + v1 + v2 + v3 == 6;
+}
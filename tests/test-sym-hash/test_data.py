@@ -0,0 +1,8 @@
+# Test symbol lookups with and without the symbol hash index
+
+test_data = {
+    "desc": "Symbol lookup with and without hash index",
+    "modules": [["mod_sym_hash.c"], {"sources": ["mod_sym_hash.c"], "args": "--no-sym-hash --name mod_sym_linear"}],
+    "required": ["Running test 'mod_sym_hash'"],
+    "total_loads": 6
+}
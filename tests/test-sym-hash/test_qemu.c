@@ -0,0 +1,68 @@
+#include "udynlink.h"
+#include "udynlink_externals.h"
+#include "mod_sym_hash_module_data.h"
+#include "mod_sym_linear_module_data.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Check that every exported function can be found and returns its own index
+static int check_funcs(const udynlink_module_t *p_mod) {
+    char name[4];
+    int (*p_func)(void);
+
+    for (int i = 0; i < 10; i ++) {
+        sprintf(name, "f%d", i);
+        if ((p_func = (int (*)(void))udynlink_get_symbol_value(p_mod, name)) == NULL) {
+            printf("Symbol '%s' not found.\n", name);
+            return 0;
+        }
+        if (p_func() != i) {
+            printf("Unexpected result from '%s'.\n", name);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int test_image(const unsigned char *p_image) {
+    const char *exported_syms[] = {"test", "v0", "v1", "v2", "v3", NULL};
+    const char *extern_syms[] = {"printf", NULL};
+    udynlink_module_t *p_mod;
+    udynlink_sym_t sym;
+    int res = 0;
+
+    for (int i = (int)_UDYNLINK_LOAD_MODE_FIRST; i <= (int)_UDYNLINK_LOAD_MODE_LAST; i ++) {
+        if ((p_mod = udynlink_load_module(p_image, NULL, 0, (udynlink_load_mode_t)i, NULL)) == NULL)
+            return 0;
+        CHECK_RAM_SIZE(p_mod, 4 * sizeof(int));
+        if (!check_exported_symbols(p_mod, exported_syms))
+            goto exit;
+        if (!check_extern_symbols(p_mod, extern_syms))
+            goto exit;
+        if (!check_funcs(p_mod))
+            goto exit;
+        // Unknown symbols must not be found (in the module or globally)
+        if ((udynlink_lookup_symbol(p_mod, "f10", &sym) != NULL) || (udynlink_lookup_symbol(NULL, "v", &sym) != NULL)) {
+            printf("Found a symbol that doesn't exist.\n");
+            goto exit;
+        }
+        if (*(int*)udynlink_get_symbol_value(NULL, "v3") != 3) {
+            printf("Unexpected value for 'v3'.\n");
+            goto exit;
+        }
+        if (!run_test_func(p_mod))
+            goto exit;
+        udynlink_unload_module(p_mod);
+    }
+    res = 1;
+    p_mod = NULL;
+exit:
+    if (p_mod)
+        udynlink_unload_module(p_mod);
+    return res;
+}
+
+int test_qemu(void) {
+    return test_image(mod_sym_hash_module_data) && test_image(mod_sym_linear_module_data);
+}
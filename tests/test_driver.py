@@ -7,8 +7,24 @@ import shutil
 import re
 
 default_qemu_timeout = 5
-compile_cmd = '../../scripts/mkmodule --gen-c-header --header-path ../qemu_host/src %s%s'
+# Recording a trace makes QEMU much slower
+trace_qemu_timeout = 120
+qemu_cmd = 'qemu-system-gnuarmeclipse -board STM32F429I-Discovery -image test1.elf -nographic'
+qemu_trace_args = ' -d exec,nochain -D %s'
+compile_cmd = '../../scripts/mkmodule --gen-c-header --header-path ../qemu_host/src %s%s%s'
+manifest_cmd = '../../scripts/mkmanifest %s'
+profile_cmd = '../../scripts/mkprofile %s %s --anchor %s'
 cleaned = False
+# Handle configurations of the loader (make variables, see qemu_host/Debug/udynlink/subdir.mk). Each test runs with the
+# fixed module table (like the default of the library) and with the handle pool, unless its 'udynlink_config' sets
+# UDYNLINK_MAX_HANDLES itself.
+handle_configs = [{"UDYNLINK_MAX_HANDLES": 8}, {"UDYNLINK_MAX_HANDLES": 0}]
+# Configuration of the loader in the last build of the QEMU test
+built_config = ""
+# Extra mkmodule arguments for all the modules (for example '--mkmodule-args=--toolchain=clang-rwpi')
+global_args = ""
+# Print the QEMU output of the tests that pass too (--show-output), for example to collect their timings
+show_output = False
 
 # Simple decorator that keeps the curent directory unchanged after running
 # a function.
@@ -39,24 +55,25 @@ def run_cmd(cmd, show_output=False, timeout=None):
         print out
     return (True, out)
 
-# Run a single test
-@keep_current_dir
-def test_one(full_path, opt):
-    sys.path.append(full_path)
-    if sys.modules.has_key("test_data"):
-        del sys.modules["test_data"]
-    from test_data import test_data
-    sys.path.remove(full_path)
-    print "--- Running test '%s' in '%s' with opt %s ---" % (test_data["desc"], os.path.basename(full_path), "-Os" if opt else "-O0")
-    os.chdir(full_path)
-    # Compile first
-    if not test_data.has_key("modules"):
-        return False, "No modules!"
-    for m in test_data["modules"]:
+# Build the given modules (lists of sources or dictionaries with the sources and extra mkmodule arguments)
+def build_modules(modules, opt):
+    for m in modules:
+        # A module is either a list of sources or a dictionary with the sources and extra mkmodule arguments
+        extra = ""
+        if isinstance(m, dict):
+            extra = m.get("args", "") + " "
+            m = m["sources"]
         srcs = " ".join(m)
-        cmd = compile_cmd % ("" if opt else "--no-opt ", srcs)
+        cmd = compile_cmd % ("" if opt else "--no-opt ", global_args + extra, srcs)
         if not run_cmd(cmd)[0]:
             return False, "Unable to compile module(s) " + srcs
+    return True, None
+
+# Build the QEMU test of the test in the current directory, run it and check its output for the 'required' strings
+# of the test and for the strings in 'extra_required'. If 'trace' is given, QEMU records the blocks that it executes to
+# this file.
+@keep_current_dir
+def run_qemu_test(test_data, config, trace=None, extra_required=[]):
     # Copy qemu test in its directory
     shutil.copyfile("test_qemu.c", os.path.join("../qemu_host/src", "test_qemu.c"))
     # Build qemu test
@@ -66,36 +83,126 @@ def test_one(full_path, opt):
         if not run_cmd("make clean")[0]:
             return False
         cleaned = True
-    if not run_cmd("make test1.elf")[0]:
+    # Rebuild the loader when its configuration changes
+    global built_config
+    if config != built_config and os.path.isfile("udynlink/udynlink.o"):
+        os.remove("udynlink/udynlink.o")
+    built_config = config
+    # Extra libraries of the test (a single word, since run_cmd splits the command at spaces)
+    libs = " TEST_LIBS=" + test_data["libs"] if test_data.has_key("libs") else ""
+    if not run_cmd("make test1.elf " + config + libs)[0]:
         return False, "Unable to build test"
     # Run QEMU with the freshly compiled test
     print "--- Running QEMU ---"
-    res, out = run_cmd("qemu-system-gnuarmeclipse -board STM32F429I-Discovery -image test1.elf -nographic", timeout=default_qemu_timeout)
+    if trace:
+        res, out = run_cmd(qemu_cmd + qemu_trace_args % trace, timeout=trace_qemu_timeout)
+    else:
+        res, out = run_cmd(qemu_cmd, timeout=default_qemu_timeout)
     if not res:
         return False, "**** Unable to run QEMU or timeout running ****"
     # Check result
     if out.find("*** TEST OK ***") == -1:
         return False, "**** Can't find the test OK indicator in the output ****\n" + out
-    for t in test_data.get("required", []):
+    for t in test_data.get("required", []) + extra_required:
         finds = re.findall(t, out, re.MULTILINE)
         if len(finds) < test_data.get("total_loads", 3): # consider each load mode in turn
             return False, "**** Can't find '%s' in output ****" % t + out
     return True, out
 
+# Read a call count profile ("name count" lines)
+def read_profile(fname):
+    res = {}
+    with open(fname, "rt") as f:
+        for l in f:
+            l = l.split("#")[0].split()
+            if len(l) == 2:
+                res[l[0]] = int(l[1])
+    return res
+
+# Generate the call count profile of a module from the QEMU trace of a test with mkprofile, then compare it with the
+# expected call counts. The test prints the address of a function of the module as "Profile anchor: NAME=ADDRESS".
+# A function can be counted once more when an interrupt returns to its first instruction, so the counts are only
+# compared approximately.
+def check_profile(profile, trace, out):
+    m = re.search(r"Profile anchor: (\S+=0x[0-9A-Fa-f]+)", out)
+    if not m:
+        return False, "**** Can't find the profile anchor in the output ****\n" + out
+    if not run_cmd(profile_cmd % (profile["elf"], trace, m.group(1)), show_output=True)[0]:
+        return False, "Unable to generate the profile of '%s'" % profile["elf"]
+    actual = read_profile(os.path.splitext(profile["elf"])[0] + ".profile")
+    for name, count in sorted(read_profile(profile["expected"]).items()):
+        if not actual.has_key(name) or abs(actual[name] - count) > max(2, count / 100):
+            return False, "**** Function '%s' called %s time(s) instead of %d ****" % (name, actual.get(name, "no"), count)
+    return True, out
+
+# Run a single test
+@keep_current_dir
+def test_one(full_path, opt, handles):
+    sys.path.append(full_path)
+    if sys.modules.has_key("test_data"):
+        del sys.modules["test_data"]
+    from test_data import test_data
+    sys.path.remove(full_path)
+    # A test that sets the handle configuration itself runs only once
+    if test_data.get("udynlink_config", {}).has_key("UDYNLINK_MAX_HANDLES") and handles != handle_configs[0]:
+        return None, None
+    config = dict(handles)
+    config.update(test_data.get("udynlink_config", {}))
+    config = " ".join(["%s=%s" % (k, v) for k, v in sorted(config.items())])
+    print "--- Running test '%s' in '%s' with opt %s ---" % (test_data["desc"], os.path.basename(full_path), "-Os" if opt else "-O0")
+    print "Loader configuration: %s" % config
+    os.chdir(full_path)
+    # Compile first
+    if not test_data.has_key("modules"):
+        return False, "No modules!"
+    res, out = build_modules(test_data["modules"], opt)
+    if not res:
+        return res, out
+    # Generate the host symbol data (and check the modules) if needed
+    if test_data.has_key("manifest_args"):
+        if not run_cmd(manifest_cmd % test_data["manifest_args"])[0]:
+            return False, "Unable to generate host symbol data"
+    # Tests with a 'profile' record a trace of their first run and check the profile generated from it
+    trace = os.path.join(full_path, "qemu.trace") if test_data.has_key("profile") else None
+    res, out = run_qemu_test(test_data, config, trace)
+    if res and trace:
+        res, out = check_profile(test_data["profile"], trace, out)
+        if res:
+            os.remove(trace)
+    # Tests with two stages (like profile-guided optimization) rebuild their modules using the results of the first
+    # run, then run again and check the output listed under 'rebuild_required' too
+    if res and test_data.has_key("rebuild"):
+        print "--- Rebuilding the modules ---"
+        res, out = build_modules(test_data["rebuild"], opt)
+        if res:
+            res, out = run_qemu_test(test_data, config, extra_required=test_data.get("rebuild_required", []))
+    return res, out
+
 total, failed = 0, 0
-tests = sys.argv[1:] if len(sys.argv) > 1 else os.listdir(".")
+tests = [a for a in sys.argv[1:] if not a.startswith("--")]
+for a in sys.argv[1:]:
+    if a.startswith("--mkmodule-args="):
+        global_args += a.split("=", 1)[1] + " "
+    elif a == "--show-output":
+        show_output = True
+tests = tests or os.listdir(".")
 for l in tests:
     # Look through all dirs that begin with "test-" and have a test_data.py file
     if l.startswith("test-") and os.path.isdir(l) and os.path.isfile(os.path.join(l, "test_data.py")):
         for opt in [False, True]:
-            res, out = test_one(os.path.abspath(l), opt)
-            total += 1
-            if not res:
-                print "--- TEST FAILED! ---"
-                print out + "\n"
-                failed += 1
-            else:
-                print "--- TEST OK ---\n"
+            for handles in handle_configs:
+                res, out = test_one(os.path.abspath(l), opt, handles)
+                if res is None:
+                    continue
+                total += 1
+                if not res:
+                    print "--- TEST FAILED! ---"
+                    print out + "\n"
+                    failed += 1
+                else:
+                    if show_output:
+                        print out
+                    print "--- TEST OK ---\n"
 
 print '*' * 20
 print "Total:  %d" % total
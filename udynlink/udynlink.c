@@ -14,11 +14,98 @@
 #define UDYNLINK_MAX_HANDLES                  1
 #endif
 
+#ifndef UDYNLINK_EXPORT_INDEX
+#define UDYNLINK_EXPORT_INDEX                 1
+#endif
+
+#ifndef UDYNLINK_STREAM_BUFFER_SIZE
+#define UDYNLINK_STREAM_BUFFER_SIZE           64
+#endif
+
+#ifndef UDYNLINK_FLASH_LOT
+#define UDYNLINK_FLASH_LOT                    0
+#endif
+
 #define UDYNLINK_MODULE_SIGN                  (((uint32_t)'M' << 24) | ((uint32_t)'L' << 16) | ((uint32_t)'D' << 8) | (uint32_t)'U')
 
-static udynlink_module_t module_table[UDYNLINK_MAX_HANDLES];
 static udynlink_debug_level_t debug_level;
 
+// Code range index used by udynlink_get_lot_base, kept sorted by the start address of the code
+typedef struct {
+    uint32_t code_start;                        // first address of the module's code
+    uint32_t code_end;                          // first address after the module's code
+    uint32_t lot_base;                          // LOT base (r9) for code in this range
+    udynlink_module_t *p_mod;                   // module that owns the range
+} code_range_t;
+
+// Entry point of an exported function for a given instance (see udynlink_get_instance_symbol). The code sets r9 to
+// the LOT base of the instance and calls the body of the function (after its export wrapper, which would set r9 to
+// the LOT base of the selected instance). The literals follow the code, so the structure must be word aligned.
+typedef struct _udynlink_thunk_t {
+    uint16_t code[10];                          // Thumb code (see thunk_code)
+    uint32_t lot_base;                          // LOT base of the instance
+    uint32_t body;                              // address of the body of the function (with the Thumb bit set)
+    struct _udynlink_thunk_t *p_next;           // next entry point of the same instance
+} udynlink_thunk_t;
+
+static const uint16_t thunk_code[10] = {
+    0xE92D, 0x4200,                             // push.w  {r9, lr}
+    0xF8DF, 0x900C,                             // ldr.w   r9, lot_base
+    0xF8DF, 0xC00C,                             // ldr.w   ip, body
+    0x47E0,                                     // blx     ip
+    0xE8BD, 0x8200,                             // pop.w   {r9, pc}
+    0xBF00                                      // nop (aligns the literals)
+};
+
+#define UDYNLINK_NO_RANGE                     0xFFFFFFFF
+
+#if UDYNLINK_MAX_HANDLES > 0
+static udynlink_module_t module_table[UDYNLINK_MAX_HANDLES];
+static code_range_t code_ranges[2 * UDYNLINK_MAX_HANDLES]; // modules in XIP mode can have a second range (.ramfunc)
+#else // #if UDYNLINK_MAX_HANDLES > 0
+// Handles are allocated on demand, in chunks of UDYNLINK_HANDLE_CHUNK entries. The free entries are kept in a list and
+// the used ones in a hash index by module name. Chunks are never freed.
+#ifndef UDYNLINK_HANDLE_CHUNK
+#define UDYNLINK_HANDLE_CHUNK                 8
+#endif
+#define UDYNLINK_NAME_INDEX_MIN_BUCKETS       16      // must be a power of 2
+
+typedef struct _module_entry_t {
+    udynlink_module_t mod;                      // module handle (must be the first field)
+    struct _module_entry_t *p_next;             // next free entry (free entries) or next entry in the same bucket (used entries)
+    uint32_t name_hash;                         // hash of the module name (used entries)
+} module_entry_t;
+
+static module_entry_t *p_free_entries;
+static module_entry_t *initial_buckets[UDYNLINK_NAME_INDEX_MIN_BUCKETS];
+static module_entry_t **p_name_index = initial_buckets;
+static uint32_t num_name_buckets = UDYNLINK_NAME_INDEX_MIN_BUCKETS, num_modules;
+static code_range_t *code_ranges;
+static uint32_t max_code_ranges;
+#endif // #if UDYNLINK_MAX_HANDLES > 0
+static uint32_t num_code_ranges;
+static volatile uint32_t last_range_idx;        // most recently hit entry in code_ranges (single word, so it can be updated atomically)
+static uint32_t lot_cache_hits, lot_cache_misses;
+
+#if UDYNLINK_EXPORT_INDEX
+// Global index of the symbols exported by all loaded modules (open addressing with linear probing)
+typedef struct {
+    const udynlink_module_t *p_mod;             // module that exports the symbol (NULL for a free slot)
+    uint32_t hash;                              // hash of the symbol name
+    uint32_t sym_idx;                           // index of the symbol in the symbol table of the module
+} export_entry_t;
+
+#define UDYNLINK_EXPORT_INDEX_MIN_SIZE        32      // must be a power of 2
+
+static export_entry_t *p_export_index;
+static uint32_t export_index_size;
+#endif // #if UDYNLINK_EXPORT_INDEX
+static uint32_t num_exports, num_duplicate_exports;
+
+// Host symbols used to resolve ordinal imports
+static const udynlink_host_export_t *host_exports;
+static uint32_t num_host_exports;
+
 #define _UDYNLINK_EXPAND(x)                   #x"\n"
 static const char * const error_codes[] = {
     UDYNLINK_ERROR_CODES
@@ -32,6 +119,30 @@ static const char * const error_codes[] = {
 #define UDYNLINK_SYM_INFO_TYPE_MASK           0x03
 #define UDYNLINK_SYM_NAME_OFFSET              0
 
+// The first word of the symbol table holds the number of entries (low 24 bits) and the module flags (high 8 bits)
+#define UDYNLINK_SYMT_COUNT_MASK              0x00FFFFFF
+#define UDYNLINK_SYMT_FLAGS_SHIFT             24
+#define UDYNLINK_SYMT_FLAG_EXT                0x01    // an extension area follows the symbol table entries
+#define UDYNLINK_SYMT_FLAG_ORDINALS           0x02    // extern symbols are imported by ordinal (offset = ordinal, value = hash)
+#define UDYNLINK_SYMT_FLAG_R9_DATA            0x04    // the code accesses the data relative to r9 (data must follow the LOT)
+
+// Extension area: a size word (in bytes, including itself), then a list of blocks. Each block starts with
+// a word that holds the block tag (high 8 bits) and the size of the block data in bytes (low 24 bits).
+#define UDYNLINK_EXT_TAG_SHIFT                24
+#define UDYNLINK_EXT_SIZE_MASK                0x00FFFFFF
+#define UDYNLINK_EXT_TAG_SYM_HASH             1       // hash index over the names in the symbol table
+#define UDYNLINK_EXT_TAG_LOT_SLOTS            2       // code offsets of the LOT base literals in direct export wrappers
+#define UDYNLINK_EXT_TAG_LAZY_IMPORTS         3       // LOT index of the binder, then (LOT index, symbol index) pairs
+#define UDYNLINK_EXT_TAG_COMPRESSION          4       // sizes of the LZ4 blocks that hold the code and the data
+#define UDYNLINK_EXT_TAG_PRELINK              5       // RAM and code addresses, number of prelinked relocations, LOT
+#define UDYNLINK_EXT_TAG_SECTIONS             6       // sizes of the sections with their own placement (see below)
+#define UDYNLINK_EXT_TAG_EXPORT_BODIES        7       // (export wrapper, body) code offset pairs of the wrapped exports
+
+// Sections with their own placement and initialization policy (indexes in the UDYNLINK_EXT_TAG_SECTIONS block)
+#define UDYNLINK_SECTION_RAMFUNC              0       // end of the code, copied to RAM in XIP mode
+#define UDYNLINK_SECTION_FASTDATA             1       // start of .data, can follow the LOT when the segments are placed
+#define UDYNLINK_SECTION_NOINIT               2       // end of .bss, not zeroed when the module is loaded
+
 // Module structure masks
 #define UDYNLINK_LOAD_MODE_MASK               (uint8_t)0x03
 #define UDYNLINK_LOAD_FOREIGN_RAM_MASK        (uint8_t)0x04
@@ -40,6 +151,21 @@ static const char * const error_codes[] = {
 #define UDYNLINK_LOAD_IS_FOREIGN_RAM(p_mod)   ((p_mod->info & UDYNLINK_LOAD_FOREIGN_RAM_MASK) != 0)
 #define UDYNLINK_LOAD_SET_FOREIGN_RAM(p_mod)  p_mod->info |= UDYNLINK_LOAD_FOREIGN_RAM_MASK
 #define UDYNLINK_LOAD_CLR_FOREIGN_RAM(p_mod)  p_mod->info &= (uint8_t)~UDYNLINK_LOAD_FOREIGN_RAM_MASK
+#define UDYNLINK_LOAD_FLASH_LOT_MASK          (uint8_t)0x08
+#define UDYNLINK_LOAD_IS_FLASH_LOT(p_mod)     ((p_mod->info & UDYNLINK_LOAD_FLASH_LOT_MASK) != 0)
+#define UDYNLINK_LOAD_SET_FLASH_LOT(p_mod)    p_mod->info |= UDYNLINK_LOAD_FLASH_LOT_MASK
+#define UDYNLINK_LOAD_SPLIT_DATA_MASK         (uint8_t)0x10
+#define UDYNLINK_LOAD_IS_SPLIT_DATA(p_mod)    ((p_mod->info & UDYNLINK_LOAD_SPLIT_DATA_MASK) != 0)
+#define UDYNLINK_LOAD_SET_SPLIT_DATA(p_mod)   p_mod->info |= UDYNLINK_LOAD_SPLIT_DATA_MASK
+
+// Installed modules (see udynlink_install_module): this header, then the LOT, then the relocated .data
+#define UDYNLINK_INSTALLED_SIGN               (((uint32_t)'I' << 24) | ((uint32_t)'L' << 16) | ((uint32_t)'D' << 8) | (uint32_t)'U')
+typedef struct {
+    uint32_t sign;                              // UDYNLINK_INSTALLED_SIGN
+    uint32_t image;                             // address of the module image
+    uint32_t ram;                               // address of .data and .bss in RAM
+    uint32_t num_lot;                           // number of LOT entries (same as in the module header)
+} installed_header_t;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Helpers - debug
@@ -80,12 +206,21 @@ static uint32_t get_code_offset_from_header(const udynlink_module_header_t *p_he
     return res;
 }
 
+// Gets the offset of the code (or of the module header in COPY_ALL mode) in the RAM area of a module
+// The RAM starts with the LOT, followed by .data and .bss, so that the data is always at the same offset from
+// the LOT base (r9), regardless of the load mode. The code (or the whole module) is copied after .bss.
+static uint32_t get_ram_code_offset(const udynlink_module_header_t *p_header) {
+    return p_header->num_lot * sizeof(uint32_t) + p_header->data_size + p_header->bss_size;
+}
+
 // Gets the address of the code
 static uint8_t *get_code_pointer(const udynlink_module_t *p_mod) {
     const udynlink_module_header_t *p_header = p_mod->p_header;
 
-    if (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_COPY_CODE) { // the code is after the LOT in RAM.
-        return (uint8_t*)p_mod->p_ram + p_header->num_lot * sizeof(uint32_t);// the code is after the LOT in RAM.
+    if (p_mod->p_shared != NULL) { // instances run the code of their module
+        return get_code_pointer(p_mod->p_shared);
+    } else if (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_COPY_CODE) { // the code is in RAM
+        return p_mod->p_code_ram;
     } else { // the code is after the module header, the relocations and the symbol table
         return (uint8_t*)p_header + get_code_offset_from_header(p_header);
     }
@@ -93,19 +228,7 @@ static uint8_t *get_code_pointer(const udynlink_module_t *p_mod) {
 
 // Gets the address of the data section (in RAM)
 static uint8_t *get_data_pointer(const udynlink_module_t *p_mod) {
-    const udynlink_module_header_t *p_header = p_mod->p_header;
-
-    switch (UDYNLINK_LOAD_GET_MODE(p_mod)) {
-        case UDYNLINK_LOAD_MODE_XIP: // the data is after the LOT
-            return (uint8_t*)p_mod->p_ram + p_header->num_lot * sizeof(uint32_t);
-        case UDYNLINK_LOAD_MODE_COPY_CODE: // the data is after the code in RAM (which is in turn after the LOT)
-            return (uint8_t*)p_mod->p_ram + p_header->num_lot * sizeof(uint32_t) + p_header->code_size;
-        case UDYNLINK_LOAD_MODE_COPY_ALL: // use directly the data section from the module header (after the code section)
-            return (uint8_t*)p_header + get_code_offset_from_header(p_header) + p_header->code_size;
-        default:
-            UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Invalid load mode %d\n", (int)UDYNLINK_LOAD_GET_MODE(p_mod));
-            return NULL;
-    }
+    return p_mod->p_data;
 }
 
 // Gets the pointer to the symbol table according to the given module header
@@ -122,9 +245,200 @@ static const uint32_t *get_relocs_pointer(const udynlink_module_t *p_mod) {
     return (const uint32_t*)p_header + sizeof(udynlink_module_header_t) / sizeof(uint32_t);
 }
 
+// Returns the module flags (stored in the first word of the symbol table)
+static uint32_t get_module_flags(const udynlink_module_t *p_mod) {
+    return *get_sym_table_pointer(p_mod) >> UDYNLINK_SYMT_FLAGS_SHIFT;
+}
+
+// Returns the number of entries in the symbol table
+static uint32_t get_sym_count(const udynlink_module_t *p_mod) {
+    return *get_sym_table_pointer(p_mod) & UDYNLINK_SYMT_COUNT_MASK;
+}
+
+// Returns the data of the extension block with the given tag (and its size in bytes in p_size) or NULL if
+// the module doesn't have an extension block with that tag.
+static const uint32_t *get_ext_block(const udynlink_module_t *p_mod, uint32_t tag, uint32_t *p_size) {
+    const uint32_t *p_symt = get_sym_table_pointer(p_mod), *p_ext, *p_end;
+
+    if ((get_module_flags(p_mod) & UDYNLINK_SYMT_FLAG_EXT) == 0) {
+        return NULL;
+    }
+    // The extension area starts right after the symbol table entries
+    p_ext = p_symt + 1 + get_sym_count(p_mod) * 2;
+    p_end = p_ext + *p_ext / sizeof(uint32_t);
+    for (p_ext ++; p_ext < p_end; p_ext += 1 + (*p_ext & UDYNLINK_EXT_SIZE_MASK) / sizeof(uint32_t)) {
+        if ((*p_ext >> UDYNLINK_EXT_TAG_SHIFT) == tag) {
+            if (p_size != NULL) {
+                *p_size = *p_ext & UDYNLINK_EXT_SIZE_MASK;
+            }
+            return p_ext + 1;
+        }
+    }
+    return NULL;
+}
+
+// Returns the size of a section with its own placement (UDYNLINK_SECTION_xxx) or 0 if the module doesn't have it
+static uint32_t get_section_size(const udynlink_module_t *p_mod, uint32_t sect) {
+    uint32_t size;
+    const uint32_t *p_sects = get_ext_block(p_mod, UDYNLINK_EXT_TAG_SECTIONS, &size);
+
+    return (p_sects != NULL) && (size > sect * sizeof(uint32_t)) ? p_sects[sect] : 0;
+}
+
+// Gets the address of the code at the given offset. In XIP mode, .ramfunc (at the end of the code) runs from its copy
+// in RAM.
+static uint32_t get_code_address(const udynlink_module_t *p_mod, uint32_t offset) {
+    const udynlink_module_header_t *p_header = p_mod->p_header;
+    uint32_t ramfunc_size;
+
+    if (p_mod->p_shared != NULL) { // instances run the code of their module
+        p_mod = p_mod->p_shared;
+    }
+    if ((UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_XIP) && ((ramfunc_size = get_section_size(p_mod, UDYNLINK_SECTION_RAMFUNC)) > 0) &&
+        (offset >= p_header->code_size - ramfunc_size)) {
+        return (uint32_t)p_mod->p_code_ram + offset - (p_header->code_size - ramfunc_size);
+    }
+    return (uint32_t)get_code_pointer(p_mod) + offset;
+}
+
+// Gets the address of the data at the given offset in .data (or .bss). If the segments of the module were placed with
+// .fastdata after the LOT (split data), .fastdata isn't contiguous with the rest of the data.
+static uint8_t *get_data_address(const udynlink_module_t *p_mod, uint32_t offset) {
+    if (UDYNLINK_LOAD_IS_SPLIT_DATA(p_mod) && (offset < get_section_size(p_mod, UDYNLINK_SECTION_FASTDATA))) {
+        return (uint8_t*)p_mod->lot_base + p_mod->p_header->num_lot * sizeof(uint32_t) + offset;
+    }
+    return get_data_pointer(p_mod) + offset;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Helpers - various
 
+// Compute the hash of a symbol name (32-bit FNV-1a, must be kept in sync with 'get_name_hash' in udynlink_utils.py)
+static uint32_t get_name_hash(const char *name) {
+    uint32_t h = 2166136261u;
+
+    while (*name) {
+        h = (h ^ (uint8_t)*name ++) * 16777619u;
+    }
+    return h;
+}
+
+// Source of an LZ4 block: either a block in memory or a block pulled in chunks through a read function
+typedef struct {
+    const uint8_t *p_crt, *p_end;               // bytes of the block that are available in memory
+    uint32_t left;                              // bytes of the block that must still be read with p_read
+    udynlink_read_func_t p_read;                // read function (NULL for blocks in memory)
+    void *p_ctx;                                // argument of p_read
+    uint8_t *p_buf;                             // buffer for p_read (UDYNLINK_STREAM_BUFFER_SIZE bytes)
+    int error;                                  // set if p_read failed
+} lz4_src_t;
+
+// Make sure that at least one byte of the block is available in memory.
+// Returns 1 if OK, 0 if the block ended or if it can't be read.
+static int lz4_fill(lz4_src_t *p_src) {
+    uint32_t size;
+
+    if (p_src->p_crt < p_src->p_end) {
+        return 1;
+    }
+    if (p_src->left == 0) {
+        return 0;
+    }
+    size = p_src->left < UDYNLINK_STREAM_BUFFER_SIZE ? p_src->left : UDYNLINK_STREAM_BUFFER_SIZE;
+    if (!p_src->p_read(p_src->p_ctx, p_src->p_buf, size)) {
+        p_src->error = 1;
+        p_src->left = 0;
+        return 0;
+    }
+    p_src->p_crt = p_src->p_buf;
+    p_src->p_end = p_src->p_buf + size;
+    p_src->left -= size;
+    return 1;
+}
+
+// Read a length that continues in the next bytes of the block (while they are 255) and add it to *p_len
+// Returns 1 if OK, 0 if the block ended
+static int lz4_read_len(lz4_src_t *p_src, uint32_t *p_len) {
+    uint8_t b;
+
+    do {
+        if (!lz4_fill(p_src)) {
+            return 0;
+        }
+        *p_len += (b = *p_src->p_crt ++);
+    } while (b == 255);
+    return 1;
+}
+
+// Decompress an LZ4 block to p_dst, which must be filled exactly (dst_size bytes). The matches are copied from the
+// data that was already decompressed, so no buffer is needed besides the destination (and the read buffer of
+// blocks that are not in memory).
+// Must be kept in sync with 'lz4_compress' in udynlink_utils.py.
+// Returns 1 if OK, 0 if the block is corrupted or can't be read.
+static int lz4_decompress(lz4_src_t *p_src, uint8_t *p_dst, uint32_t dst_size) {
+    uint8_t *p_crt = p_dst, *p_dst_end = p_dst + dst_size;
+    uint32_t len, off;
+    uint8_t token;
+
+    while (lz4_fill(p_src)) {
+        // Literals (the length continues in the next bytes if the token holds 15)
+        token = *p_src->p_crt ++;
+        if (((len = token >> 4) == 15) && !lz4_read_len(p_src, &len)) {
+            return 0;
+        }
+        if (len > (uint32_t)(p_dst_end - p_crt)) {
+            return 0;
+        }
+        while (len > 0) {
+            if (!lz4_fill(p_src)) {
+                return 0;
+            }
+            off = (uint32_t)(p_src->p_end - p_src->p_crt) < len ? (uint32_t)(p_src->p_end - p_src->p_crt) : len;
+            memcpy(p_crt, p_src->p_crt, off);
+            p_crt += off;
+            p_src->p_crt += off;
+            len -= off;
+        }
+        if (!lz4_fill(p_src)) { // the last sequence has only literals
+            break;
+        }
+        // Match: 16-bit offset back in the output and length
+        off = *p_src->p_crt ++;
+        if (!lz4_fill(p_src)) {
+            return 0;
+        }
+        off |= (uint32_t)*p_src->p_crt ++ << 8;
+        if (((len = token & 0x0F) == 15) && !lz4_read_len(p_src, &len)) {
+            return 0;
+        }
+        len += 4;
+        if ((off == 0) || (off > (uint32_t)(p_crt - p_dst)) || (len > (uint32_t)(p_dst_end - p_crt))) {
+            return 0;
+        }
+        if (off >= len) { // no overlap
+            memcpy(p_crt, p_crt - off, len);
+            p_crt += len;
+        } else { // the match repeats the last "off" bytes
+            for (; len > 0; len --, p_crt ++) {
+                *p_crt = *(p_crt - off);
+            }
+        }
+    }
+    return !p_src->error && (p_crt == p_dst_end);
+}
+
+// Decompress an LZ4 block in memory
+static int lz4_decompress_mem(const uint8_t *p_block, uint32_t size, uint8_t *p_dst, uint32_t dst_size) {
+    lz4_src_t src = {p_block, p_block + size, 0, NULL, NULL, NULL, 0};
+
+    return lz4_decompress(&src, p_dst, dst_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Helpers - module table
+
+#if UDYNLINK_MAX_HANDLES > 0
+
 // Find the next free entry in the module table, return a pointer to it o NULL
 static udynlink_module_t *get_next_free_module(void) {
     for (uint32_t i = 0; i < UDYNLINK_MAX_HANDLES; i ++) {
@@ -140,6 +454,266 @@ static void mark_module_free(udynlink_module_t *p_mod) {
     memset(p_mod, 0, sizeof(udynlink_module_t));
 }
 
+// Add the given (loaded) module to the name index (nothing to do for a fixed module table)
+static void index_module(udynlink_module_t *p_mod) {
+    (void)p_mod;
+}
+
+// Remove the given module from the name index (nothing to do for a fixed module table)
+static void unindex_module(udynlink_module_t *p_mod) {
+    (void)p_mod;
+}
+
+// Find a loaded module (other than p_except) with the given name. Instances are skipped, like in the name index.
+static udynlink_module_t *find_module(const char *name, const udynlink_module_t *p_except) {
+    for (uint32_t i = 0; i < UDYNLINK_MAX_HANDLES; i ++) {
+        if ((module_table + i != p_except) && (module_table[i].p_header != NULL) && (module_table[i].p_shared == NULL) && !strcmp(name, udynlink_get_module_name(module_table + i))) {
+            return module_table + i;
+        }
+    }
+    return NULL;
+}
+
+#if !UDYNLINK_EXPORT_INDEX
+// Returns the loaded module after p_mod (or the first one if p_mod is NULL) or NULL if there are no more modules
+static udynlink_module_t *get_next_module(const udynlink_module_t *p_mod) {
+    for (uint32_t i = p_mod == NULL ? 0 : (uint32_t)(p_mod - module_table) + 1; i < UDYNLINK_MAX_HANDLES; i ++) {
+        if ((module_table[i].p_header != NULL) && (module_table[i].p_shared == NULL)) {
+            return module_table + i;
+        }
+    }
+    return NULL;
+}
+#endif
+
+// Make sure that there's space for 'cnt' more code ranges (the code range index has two entries per handle)
+static udynlink_error_t reserve_code_ranges(uint32_t cnt) {
+    return num_code_ranges + cnt <= sizeof(code_ranges) / sizeof(code_ranges[0]) ? UDYNLINK_OK : UDYNLINK_ERR_LOAD_NO_MORE_HANDLES;
+}
+
+#else // #if UDYNLINK_MAX_HANDLES > 0
+
+// Add the given memory to the free handle list, return the number of handles added
+static uint32_t add_free_entries(void *p_mem, uint32_t size) {
+    module_entry_t *p_entries = (module_entry_t*)p_mem;
+    uint32_t cnt = size / sizeof(module_entry_t);
+
+    for (uint32_t i = 0; i < cnt; i ++) {
+        memset(p_entries + i, 0, sizeof(module_entry_t));
+        p_entries[i].p_next = p_free_entries;
+        p_free_entries = p_entries + i;
+    }
+    return cnt;
+}
+
+// Get a free handle from the free list, allocating a new chunk of handles if needed. Returns NULL if out of memory.
+static udynlink_module_t *get_next_free_module(void) {
+    module_entry_t *p_entry;
+    void *p_chunk;
+
+    if (p_free_entries == NULL) {
+        if ((p_chunk = udynlink_external_malloc(UDYNLINK_HANDLE_CHUNK * sizeof(module_entry_t))) == NULL) {
+            return NULL;
+        }
+        add_free_entries(p_chunk, UDYNLINK_HANDLE_CHUNK * sizeof(module_entry_t));
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Allocated %d new module handles at %p\n", UDYNLINK_HANDLE_CHUNK, p_chunk);
+    }
+    p_entry = p_free_entries;
+    p_free_entries = p_entry->p_next;
+    memset(p_entry, 0, sizeof(module_entry_t));
+    return &p_entry->mod;
+}
+
+// Return the given handle to the free list
+static void mark_module_free(udynlink_module_t *p_mod) {
+    module_entry_t *p_entry = (module_entry_t*)p_mod;
+
+    memset(p_entry, 0, sizeof(module_entry_t));
+    p_entry->p_next = p_free_entries;
+    p_free_entries = p_entry;
+}
+
+// Double the number of buckets in the name index. If there isn't enough memory, the index keeps its current size
+// (it still works, but the chains get longer).
+static void grow_name_index(void) {
+    uint32_t new_size = num_name_buckets * 2;
+    module_entry_t **p_new = (module_entry_t**)udynlink_external_malloc(new_size * sizeof(module_entry_t*));
+
+    if (p_new == NULL) {
+        return;
+    }
+    memset(p_new, 0, new_size * sizeof(module_entry_t*));
+    for (uint32_t i = 0; i < num_name_buckets; i ++) {
+        for (module_entry_t *p_entry = p_name_index[i], *p_next; p_entry != NULL; p_entry = p_next) {
+            p_next = p_entry->p_next;
+            p_entry->p_next = p_new[p_entry->name_hash & (new_size - 1)];
+            p_new[p_entry->name_hash & (new_size - 1)] = p_entry;
+        }
+    }
+    if (p_name_index != initial_buckets) {
+        udynlink_external_free(p_name_index);
+    }
+    p_name_index = p_new;
+    num_name_buckets = new_size;
+}
+
+// Add the given (loaded) module to the name index
+static void index_module(udynlink_module_t *p_mod) {
+    module_entry_t *p_entry = (module_entry_t*)p_mod;
+
+    if (num_modules >= num_name_buckets) {
+        grow_name_index();
+    }
+    p_entry->name_hash = get_name_hash(udynlink_get_module_name(p_mod));
+    p_entry->p_next = p_name_index[p_entry->name_hash & (num_name_buckets - 1)];
+    p_name_index[p_entry->name_hash & (num_name_buckets - 1)] = p_entry;
+    num_modules ++;
+}
+
+// Remove the given module from the name index
+static void unindex_module(udynlink_module_t *p_mod) {
+    module_entry_t *p_entry = (module_entry_t*)p_mod;
+
+    for (module_entry_t **pp = p_name_index + (p_entry->name_hash & (num_name_buckets - 1)); *pp != NULL; pp = &(*pp)->p_next) {
+        if (*pp == p_entry) {
+            *pp = p_entry->p_next;
+            num_modules --;
+            return;
+        }
+    }
+}
+
+// Find a loaded module (other than p_except) with the given name
+static udynlink_module_t *find_module(const char *name, const udynlink_module_t *p_except) {
+    uint32_t hash = get_name_hash(name);
+
+    for (module_entry_t *p_entry = p_name_index[hash & (num_name_buckets - 1)]; p_entry != NULL; p_entry = p_entry->p_next) {
+        if ((&p_entry->mod != p_except) && (p_entry->name_hash == hash) && !strcmp(name, udynlink_get_module_name(&p_entry->mod))) {
+            return &p_entry->mod;
+        }
+    }
+    return NULL;
+}
+
+#if !UDYNLINK_EXPORT_INDEX
+// Returns the loaded module after p_mod (or the first one if p_mod is NULL) or NULL if there are no more modules
+static udynlink_module_t *get_next_module(const udynlink_module_t *p_mod) {
+    const module_entry_t *p_entry = (const module_entry_t*)p_mod;
+    uint32_t i = 0;
+
+    if (p_entry != NULL) {
+        if (p_entry->p_next != NULL) {
+            return &p_entry->p_next->mod;
+        }
+        i = (p_entry->name_hash & (num_name_buckets - 1)) + 1;
+    }
+    for (; i < num_name_buckets; i ++) {
+        if (p_name_index[i] != NULL) {
+            return &p_name_index[i]->mod;
+        }
+    }
+    return NULL;
+}
+#endif
+
+// Make sure that there's space for 'cnt' more code ranges, growing the code range index if needed
+static udynlink_error_t reserve_code_ranges(uint32_t cnt) {
+    code_range_t *p_new, *p_old = code_ranges;
+    uint32_t new_size = max_code_ranges == 0 ? UDYNLINK_HANDLE_CHUNK : max_code_ranges * 2;
+
+    if (num_code_ranges + cnt <= max_code_ranges) {
+        return UDYNLINK_OK;
+    }
+    while (new_size < num_code_ranges + cnt) {
+        new_size *= 2;
+    }
+    if ((p_new = (code_range_t*)udynlink_external_malloc(new_size * sizeof(code_range_t))) == NULL) {
+        return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+    }
+    if (num_code_ranges > 0) {
+        memcpy(p_new, p_old, num_code_ranges * sizeof(code_range_t));
+    }
+    last_range_idx = UDYNLINK_NO_RANGE;
+    code_ranges = p_new;
+    max_code_ranges = new_size;
+    if (p_old != NULL) {
+        udynlink_external_free(p_old);
+    }
+    return UDYNLINK_OK;
+}
+
+#endif // #if UDYNLINK_MAX_HANDLES > 0
+
+////////////////////////////////////////////////////////////////////////////////
+// Helpers - code ranges
+
+// Returns the number of code ranges of the given module: its code and, in XIP mode, the copy of .ramfunc in RAM
+static uint32_t get_num_code_ranges(const udynlink_module_t *p_mod) {
+    return (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_XIP) && (get_section_size(p_mod, UDYNLINK_SECTION_RAMFUNC) > 0) ? 2 : 1;
+}
+
+// Add a code range of the given module to the code range index, keeping it sorted
+static void add_code_range(udynlink_module_t *p_mod, uint32_t code_start, uint32_t code_size) {
+    uint32_t i;
+
+    last_range_idx = UDYNLINK_NO_RANGE; // invalidate the last hit cache while the table changes
+    for (i = num_code_ranges; (i > 0) && (code_ranges[i - 1].code_start > code_start); i --) {
+        code_ranges[i] = code_ranges[i - 1];
+    }
+    code_ranges[i].code_start = code_start;
+    code_ranges[i].code_end = code_start + code_size;
+    code_ranges[i].lot_base = p_mod->lot_base;
+    code_ranges[i].p_mod = p_mod;
+    num_code_ranges ++;
+}
+
+// Return the index of the first code range of the given module in the code range index, starting at index 'start'
+// (UDYNLINK_NO_RANGE if not found)
+static uint32_t find_code_range(const udynlink_module_t *p_mod, uint32_t start) {
+    for (uint32_t i = start; i < num_code_ranges; i ++) {
+        if (code_ranges[i].p_mod == p_mod) {
+            return i;
+        }
+    }
+    return UDYNLINK_NO_RANGE;
+}
+
+// Remove the code ranges of the given module from the code range index
+static void remove_code_ranges(const udynlink_module_t *p_mod) {
+    uint32_t i;
+
+    last_range_idx = UDYNLINK_NO_RANGE;
+    while ((i = find_code_range(p_mod, 0)) != UDYNLINK_NO_RANGE) {
+        num_code_ranges --;
+        memmove(code_ranges + i, code_ranges + i + 1, (num_code_ranges - i) * sizeof(code_range_t));
+    }
+}
+
+// Set the LOT base literals used by the direct export wrappers of p_mod (if any) to the LOT base of p_inst (the module
+// itself or one of its instances). In RAM, the literals are pointed to the LOT base in the structure of p_inst. In XIP
+// mode they can't be changed, so the LOT base is written to the RAM word that they already point to (set with
+// --xip-lot-slot when building the module).
+static udynlink_error_t set_lot_slots(udynlink_module_t *p_mod, udynlink_module_t *p_inst) {
+    uint32_t size;
+    const uint32_t *p_slots = get_ext_block(p_mod, UDYNLINK_EXT_TAG_LOT_SLOTS, &size);
+    uint8_t *p_code = get_code_pointer(p_mod);
+
+    for (uint32_t i = 0; (p_slots != NULL) && (i < size / sizeof(uint32_t)); i ++) {
+        uint32_t *p_lit = (uint32_t*)(p_code + p_slots[i]);
+        if (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_XIP) {
+            if (*p_lit == 0) {
+                UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Module was built without a LOT slot for XIP mode\n");
+                return UDYNLINK_ERR_LOAD_UNABLE_TO_XIP;
+            }
+            *(uint32_t*)*p_lit = p_inst->lot_base;
+        } else {
+            *p_lit = (uint32_t)&p_inst->lot_base;
+        }
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "LOT base literal at %p points to %08X\n", p_lit, *p_lit);
+    }
+    return UDYNLINK_OK;
+}
+
 // Write a value to the given error pointer only if the pointer isn't NULL
 static void write_error(udynlink_error_t *p, udynlink_error_t val) {
     if (p != NULL) {
@@ -153,7 +727,7 @@ static udynlink_sym_t *get_sym_at(const udynlink_module_t *p_mod, uint32_t index
     uint32_t name_off, info;
     const uint32_t *p_symt = get_sym_table_pointer(p_mod);
 
-    if (index >= *p_symt) { // first word in the symbol table is the number of entries
+    if (index >= (*p_symt & UDYNLINK_SYMT_COUNT_MASK)) { // first word in the symbol table is the number of entries
         return NULL;
     }
     // Read the offset to the name of the symbol and the symbol value
@@ -169,7 +743,9 @@ static udynlink_sym_t *get_sym_at(const udynlink_module_t *p_mod, uint32_t index
         return NULL;
     }
     // Get name pointer (if available)
-    if (p_sym->type != UDYNLINK_SYM_TYPE_LOCAL) { // local symbols don't have names
+    if ((p_sym->type == UDYNLINK_SYM_TYPE_EXTERN) && ((*p_symt >> UDYNLINK_SYMT_FLAGS_SHIFT) & UDYNLINK_SYMT_FLAG_ORDINALS)) {
+        p_sym->name = "(ordinal)"; // imported by ordinal, no name
+    } else if (p_sym->type != UDYNLINK_SYM_TYPE_LOCAL) { // local symbols don't have names
         p_sym->name = (const char*)p_symt + (name_off & UDYNLINK_SYM_OFFSET_MASK);
     } else {
         p_sym->name = "(N/A)";
@@ -184,117 +760,545 @@ static udynlink_sym_t *offset_sym(const udynlink_module_t *p_mod, udynlink_sym_t
 
     if ((p_sym->type == UDYNLINK_SYM_TYPE_LOCAL) || (p_sym->type == UDYNLINK_SYM_TYPE_EXPORTED)) {
         if (p_sym->location == UDYNLINK_SYM_LOCATION_CODE) {
-            p_sym->val += (uint32_t)get_code_pointer(p_mod);
+            p_sym->val = get_code_address(p_mod, p_sym->val);
         } else {
-            p_sym->val += (uint32_t)get_data_pointer(p_mod);
+            p_sym->val = (uint32_t)get_data_address(p_mod, p_sym->val);
         }
     }
     UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Symbol %s relocated relative to %s, orig value is %08X, new value is %08X\n", p_sym->name, p_sym->location == UDYNLINK_SYM_LOCATION_CODE ? "code" : "data", prev_val, p_sym->val);
     return p_sym;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// Public interface
+// Set the bits of the given name hash in the symbol filter of a module (or check them, if 'set' is 0). The filter
+// is a 64-bit bloom filter with two bits per name, both taken from the name hash.
+static int sym_filter_bits(udynlink_module_t *p_mod, uint32_t hash, int set) {
+    uint32_t b1 = hash & 63, b2 = (hash >> 6) & 63;
 
-udynlink_module_t *udynlink_load_module(const void *base_addr, void *load_addr, uint32_t load_size, udynlink_load_mode_t load_mode, udynlink_error_t *p_error) {
-    udynlink_module_t *p_mod = NULL;
-    void *ram_addr = NULL;
-    udynlink_error_t res = UDYNLINK_OK;
-    const udynlink_module_header_t *p_header = (const udynlink_module_header_t*)base_addr;
+    if (set) {
+        p_mod->sym_filter[b1 >> 5] |= 1u << (b1 & 31);
+        p_mod->sym_filter[b2 >> 5] |= 1u << (b2 & 31);
+    }
+    return (p_mod->sym_filter[b1 >> 5] & (1u << (b1 & 31))) && (p_mod->sym_filter[b2 >> 5] & (1u << (b2 & 31)));
+}
+
+// Build the symbol filter of the given module from the names in its symbol table
+// Returns the number of exported symbols in the module.
+static uint32_t build_sym_filter(udynlink_module_t *p_mod) {
     udynlink_sym_t sym;
+    uint32_t idx = 0, cnt = 0;
+    int ordinals = (get_module_flags(p_mod) & UDYNLINK_SYMT_FLAG_ORDINALS) != 0;
 
-    // Find an empty space in the module table
-    if((p_mod = get_next_free_module()) == NULL) {
-        res = UDYNLINK_ERR_LOAD_NO_MORE_HANDLES;
-        goto exit;
+    p_mod->sym_filter[0] = p_mod->sym_filter[1] = 0;
+    while (get_sym_at(p_mod, idx ++, &sym) != NULL) {
+        if ((sym.type != UDYNLINK_SYM_TYPE_LOCAL) && !(ordinals && (sym.type == UDYNLINK_SYM_TYPE_EXTERN))) {
+            sym_filter_bits(p_mod, get_name_hash(sym.name), 1);
+        }
+        cnt += sym.type == UDYNLINK_SYM_TYPE_EXPORTED;
     }
+    return cnt;
+}
 
-    // Setup the module structure. Depending on the copy mode, we might need to rewrite it later.
-    p_mod->p_header = p_header;
-    UDYNLINK_LOAD_SET_MODE(p_mod, load_mode);
+// Find the symbol with the given name (and name hash) in the symbol table of the given module and write it to p_sym
+// (without offseting its value). Names that aren't in the symbol filter of the module are rejected immediately. If the
+// module has a symbol hash index, only the corresponding bucket chain is checked, otherwise (older images) the whole
+// symbol table is searched.
+// Returns p_sym if found, NULL otherwise
+static udynlink_sym_t *find_sym(const udynlink_module_t *p_mod, const char *name, uint32_t hash, udynlink_sym_t *p_sym) {
+    const uint32_t *p_hash = get_ext_block(p_mod, UDYNLINK_EXT_TAG_SYM_HASH, NULL);
+    uint32_t idx = 0;
 
-    // Check signature
-    if (p_header->sign != UDYNLINK_MODULE_SIGN) {
-        res = UDYNLINK_ERR_LOAD_INVALID_SIGN;
-        goto exit;
+    if (!sym_filter_bits((udynlink_module_t*)p_mod, hash, 0)) {
+        return NULL;
     }
-
-    // Check if a module with a duplicated name already exists
-    for (uint32_t i = 0; i < UDYNLINK_MAX_HANDLES; i ++) {
-        // Check for other module (not p_mod) that are in use and have the same name as the module being loaded (in p_mod)
-        if ((module_table + i != p_mod) && (module_table[i].p_header != NULL) && (!strcmp(udynlink_get_module_name(module_table + i), udynlink_get_module_name(p_mod)))) {
-            res = UDYNLINK_ERR_LOAD_DUPLICATE_NAME;
-            goto exit;
+    if (p_hash != NULL) {
+        // Hash block: number of buckets (1 word), then the buckets and the chains (16 bits per entry)
+        // Each bucket holds the index of the first symbol in the bucket, each chain entry the index of the next symbol
+        // in the same bucket as the symbol with the same index. Index 0 (the module name) marks the end of a chain.
+        const uint16_t *p_buckets = (const uint16_t*)(p_hash + 1), *p_chain = p_buckets + p_hash[0];
+        for (idx = p_buckets[hash % p_hash[0]]; idx != 0; idx = p_chain[idx]) {
+            if ((get_sym_at(p_mod, idx, p_sym) != NULL) && !strcmp(p_sym->name, name)) {
+                return p_sym;
+            }
+        }
+        return NULL;
+    }
+    while (get_sym_at(p_mod, idx ++, p_sym) != NULL) { // iterate through module's symbol table
+        if (!strcmp(p_sym->name, name)) { // symbol found
+            return p_sym;
         }
     }
+    return NULL;
+}
 
-    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Processing module at %p named '%s' with load mode %d\n", base_addr, udynlink_get_module_name(p_mod), (int)load_mode);
+////////////////////////////////////////////////////////////////////////////////
+// Helpers - global export index
 
-    // Allocate RAM or check given RAM region, as needed
-    uint32_t ram_size = udynlink_get_ram_size(p_mod);
-    if (ram_size > 0) { // is any RAM needed at all?
-        if (load_addr == NULL) { // RAM must be allocated
-            UDYNLINK_LOAD_CLR_FOREIGN_RAM(p_mod);
-            if ((ram_addr = udynlink_external_malloc(ram_size)) == NULL) {
-                res = UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
-                goto exit;
-            }
-            UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Allocated %u bytes for module at %p\n", ram_size, base_addr);
-        } else { // check if the user-provided RAM region is large enough
-            UDYNLINK_LOAD_SET_FOREIGN_RAM(p_mod);
-            if (load_size < ram_size) {
-                res = UDYNLINK_ERR_LOAD_RAM_LEN_LOW;
-                goto exit;
+#if UDYNLINK_EXPORT_INDEX
+
+// Add an entry to the export index (which must have at least a free slot). Entries with the same hash are kept in
+// insertion order, so lookups find the symbol exported by the module that was loaded first.
+static void insert_export(const export_entry_t *p_entry) {
+    uint32_t mask = export_index_size - 1, i;
+
+    for (i = p_entry->hash & mask; p_export_index[i].p_mod != NULL; i = (i + 1) & mask);
+    p_export_index[i] = *p_entry;
+}
+
+// Make sure that the export index has room for 'cnt' more exports, growing it if needed. The index is kept at most
+// half full.
+static udynlink_error_t reserve_exports(uint32_t cnt) {
+    export_entry_t *p_old = p_export_index;
+    uint32_t old_size = export_index_size, new_size = UDYNLINK_EXPORT_INDEX_MIN_SIZE, start = 0;
+
+    if ((num_exports + cnt) * 2 <= export_index_size) {
+        return UDYNLINK_OK;
+    }
+    while (new_size < (num_exports + cnt) * 2) {
+        new_size *= 2;
+    }
+    if ((p_export_index = (export_entry_t*)udynlink_external_malloc(new_size * sizeof(export_entry_t))) == NULL) {
+        p_export_index = p_old;
+        return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+    }
+    memset(p_export_index, 0, new_size * sizeof(export_entry_t));
+    export_index_size = new_size;
+    if (p_old != NULL) {
+        // Move the old entries starting from a free slot, so that no probe sequence is split and the order of the
+        // entries with the same hash doesn't change
+        while (p_old[start].p_mod != NULL) {
+            start ++;
+        }
+        for (uint32_t i = 1; i <= old_size; i ++) {
+            if (p_old[(start + i) % old_size].p_mod != NULL) {
+                insert_export(p_old + (start + i) % old_size);
             }
-            ram_addr = load_addr;
         }
-        p_mod->p_ram = ram_addr;
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "RAM area for module at %p is at %p (%u bytes)\n", base_addr, ram_addr, ram_size);
-    } else {
-        p_mod->p_ram = NULL;
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Awesome! Module %p doesn't need any RAM\n", base_addr);
+        udynlink_external_free(p_old);
     }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Export index resized to %u entries\n", new_size);
+    return UDYNLINK_OK;
+}
 
-    // Copy to RAM as needed. The first part of RAM is always the LOT, so skip it.
-    uint8_t *p_temp8 = (uint8_t*)ram_addr + p_header->num_lot * sizeof(uint32_t);
-    // Reuse "load_size" (since it's not used anymore) to hold the offset to code, according to the header.
-    load_size = get_code_offset_from_header(p_header);
-    if (load_mode == UDYNLINK_LOAD_MODE_COPY_ALL) {
-        // We need to copy the whole module to RAM (header, symbol table, relocs, code, data)
-        memcpy(p_temp8, base_addr, load_size + p_header->code_size + p_header->data_size);
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Copied module at %p to RAM at %p (%u bytes)\n", base_addr, p_temp8, load_size + p_header->code_size + p_header->data_size);
-        // Since we copied everything, move the pointer to the header to RAM, since the original (base_addr) might be freed eventually.
-        p_mod->p_header = p_header = (const udynlink_module_header_t*)p_temp8;
-    } else if (load_mode == UDYNLINK_LOAD_MODE_COPY_CODE) {
-        // Copy just code and data
-        memcpy(p_temp8, (const uint8_t*)base_addr + load_size, p_header->code_size + p_header->data_size);
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Copied code and data of module %p to RAM at %p (%u bytes)\n", base_addr, p_temp8, p_header->code_size + p_header->data_size);
+// Find the exported symbol with the given name (and name hash) in the export index. Returns the module that
+// exports the symbol (and the symbol in p_sym) or NULL if not found.
+static const udynlink_module_t *find_export(const char *name, uint32_t hash, udynlink_sym_t *p_sym) {
+    uint32_t mask = export_index_size - 1;
+
+    for (uint32_t i = hash & mask; (export_index_size > 0) && (p_export_index[i].p_mod != NULL); i = (i + 1) & mask) {
+        const export_entry_t *p_entry = p_export_index + i;
+        if ((p_entry->hash == hash) && (get_sym_at(p_entry->p_mod, p_entry->sym_idx, p_sym) != NULL) && !strcmp(p_sym->name, name)) {
+            return p_entry->p_mod;
+        }
+    }
+    return NULL;
+}
+
+// Add the exported symbols of the given (loaded) module to the export index (reserve_exports must be called first)
+static void index_exports(const udynlink_module_t *p_mod) {
+    export_entry_t entry = {p_mod, 0, 0};
+    udynlink_sym_t sym, other;
+
+    while (get_sym_at(p_mod, entry.sym_idx, &sym) != NULL) {
+        if (sym.type == UDYNLINK_SYM_TYPE_EXPORTED) {
+            entry.hash = get_name_hash(sym.name);
+            if (find_export(sym.name, entry.hash, &other) != NULL) {
+                UDYNLINK_DEBUG(UDYNLINK_DEBUG_WARNING, "Symbol '%s' exported by module '%s' is already exported by another module\n", sym.name, udynlink_get_module_name(p_mod));
+                num_duplicate_exports ++;
+            }
+            insert_export(&entry);
+            num_exports ++;
+        }
+        entry.sym_idx ++;
+    }
+}
+
+// Remove the exported symbols of the given module from the export index
+static void unindex_exports(const udynlink_module_t *p_mod) {
+    uint32_t mask = export_index_size - 1, idx = 0, i, j, home;
+    udynlink_sym_t sym;
+
+    while (get_sym_at(p_mod, idx, &sym) != NULL) {
+        if (sym.type == UDYNLINK_SYM_TYPE_EXPORTED) {
+            for (i = get_name_hash(sym.name) & mask; p_export_index[i].p_mod != p_mod || p_export_index[i].sym_idx != idx; i = (i + 1) & mask);
+            // Move back the entries that follow in the same cluster (if they can go in the freed slot), so that
+            // their probe sequences stay unbroken
+            for (j = (i + 1) & mask; p_export_index[j].p_mod != NULL; j = (j + 1) & mask) {
+                home = p_export_index[j].hash & mask;
+                if ((j > i) ? ((home <= i) || (home > j)) : ((home <= i) && (home > j))) {
+                    p_export_index[i] = p_export_index[j];
+                    i = j;
+                }
+            }
+            p_export_index[i].p_mod = NULL;
+            num_exports --;
+        }
+        idx ++;
+    }
+}
+
+#else // #if UDYNLINK_EXPORT_INDEX
+
+// Without an export index, the modules are searched in turn (using their symbol filters to skip them quickly)
+static const udynlink_module_t *find_export(const char *name, uint32_t hash, udynlink_sym_t *p_sym) {
+    for (const udynlink_module_t *p_mod = get_next_module(NULL); p_mod != NULL; p_mod = get_next_module(p_mod)) {
+        if ((find_sym(p_mod, name, hash, p_sym) != NULL) && (p_sym->type == UDYNLINK_SYM_TYPE_EXPORTED)) {
+            return p_mod;
+        }
+    }
+    return NULL;
+}
+
+static udynlink_error_t reserve_exports(uint32_t cnt) {
+    (void)cnt;
+    return UDYNLINK_OK;
+}
+
+static void index_exports(const udynlink_module_t *p_mod) {
+    (void)p_mod;
+}
+
+static void unindex_exports(const udynlink_module_t *p_mod) {
+    (void)p_mod;
+}
+
+#endif // #if UDYNLINK_EXPORT_INDEX
+
+////////////////////////////////////////////////////////////////////////////////
+// Helpers - imports
+
+// Return the address of the extern symbol at the given index in the symbol table (already read in p_sym) or 0 if
+// the symbol can't be resolved. Symbols imported by ordinal are read from the host export table after checking their
+// hash. The others are resolved by name by the host or, if the host doesn't know them, from the exports of the other
+// loaded modules. In the latter case, the module that exports the symbol is written to pp_dep (otherwise it's NULL).
+static uint32_t resolve_extern(const udynlink_module_t *p_mod, uint32_t index, udynlink_sym_t *p_sym, const udynlink_module_t **pp_dep) {
+    uint32_t addr;
+
+    *pp_dep = NULL;
+    if (get_module_flags(p_mod) & UDYNLINK_SYMT_FLAG_ORDINALS) {
+        uint32_t ordinal = get_sym_table_pointer(p_mod)[index * 2 + 1] & UDYNLINK_SYM_OFFSET_MASK;
+        if ((ordinal >= num_host_exports) || (host_exports[ordinal].hash != p_sym->val)) {
+            UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Ordinal %u (hash %08X) not found in the host export table\n", ordinal, p_sym->val);
+            return 0;
+        }
+        return host_exports[ordinal].addr;
+    }
+    if ((addr = udynlink_external_resolve_symbol(p_sym->name)) != 0) {
+        return addr;
+    }
+    const char *name = p_sym->name;
+    if ((*pp_dep = find_export(name, get_name_hash(name), p_sym)) == NULL) {
+        return 0;
+    }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Symbol '%s' imported from module '%s'\n", name, udynlink_get_module_name(*pp_dep));
+    return offset_sym(*pp_dep, p_sym)->val;
+}
+
+// Record that the given module imports symbols from p_dep (if not already recorded). The list of dependencies
+// is reallocated each time its size reaches a power of 2.
+static udynlink_error_t add_dependency(udynlink_module_t *p_mod, const udynlink_module_t *p_dep) {
+    udynlink_module_t **p_new;
+
+    for (uint32_t i = 0; i < p_mod->num_deps; i ++) {
+        if (p_mod->p_deps[i] == p_dep) {
+            return UDYNLINK_OK;
+        }
+    }
+    if ((p_mod->num_deps & (p_mod->num_deps - 1)) == 0) { // 0 or a power of 2: the list is full
+        if ((p_new = (udynlink_module_t**)udynlink_external_malloc((p_mod->num_deps == 0 ? 1 : p_mod->num_deps * 2) * sizeof(udynlink_module_t*))) == NULL) {
+            return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+        }
+        if (p_mod->p_deps != NULL) {
+            memcpy(p_new, p_mod->p_deps, p_mod->num_deps * sizeof(udynlink_module_t*));
+            udynlink_external_free(p_mod->p_deps);
+        }
+        p_mod->p_deps = p_new;
+    }
+    p_mod->p_deps[p_mod->num_deps ++] = (udynlink_module_t*)p_dep;
+    return UDYNLINK_OK;
+}
+
+// Bind a lazy import on its first call (called by the stubs generated by mkmodule --lazy-imports). Finds the module
+// (or the instance) with the given LOT base and the import with the given LOT offset (in bytes), resolves it, writes
+// its address to its LOT entry (so the next calls go directly to the function) and returns it. Returns 0 if the
+// import can't be resolved (the call will fault).
+static uint32_t lazy_bind(uint32_t lot_base, uint32_t lot_offset) {
+    udynlink_module_t *p_mod = NULL;
+    const udynlink_module_t *p_dep;
+    const uint32_t *p_lazy;
+    udynlink_sym_t sym;
+    uint32_t size, addr = 0, i;
+
+    for (i = 0; (i < num_code_ranges) && (p_mod == NULL); i ++) {
+        for (p_mod = code_ranges[i].p_mod; (p_mod != NULL) && (p_mod->lot_base != lot_base); p_mod = p_mod->p_next_instance);
+    }
+    if ((p_mod == NULL) || ((p_lazy = get_ext_block(p_mod, UDYNLINK_EXT_TAG_LAZY_IMPORTS, &size)) == NULL)) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "No module with lazy imports has its LOT at %08X\n", lot_base);
+        return 0;
+    }
+    for (i = 1; i + 1 < size / sizeof(uint32_t); i += 2) {
+        if (p_lazy[i] == lot_offset / sizeof(uint32_t)) {
+            if ((get_sym_at(p_mod, p_lazy[i + 1], &sym) != NULL) && ((addr = resolve_extern(p_mod, p_lazy[i + 1], &sym, &p_dep)) != 0)) {
+                break;
+            }
+        }
+    }
+    if (addr == 0) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Unable to bind the lazy import at LOT offset %u in module '%s'\n", lot_offset, udynlink_get_module_name(p_mod));
+        return 0;
+    }
+    if (p_dep != NULL) {
+        if (add_dependency(p_mod, p_dep) == UDYNLINK_OK) {
+            ((udynlink_module_t*)p_dep)->ref_count ++;
+        } else {
+            UDYNLINK_DEBUG(UDYNLINK_DEBUG_WARNING, "Unable to record the dependency of module '%s' on module '%s'\n", udynlink_get_module_name(p_mod), udynlink_get_module_name(p_dep));
+        }
+    }
+    ((uint32_t*)lot_base)[lot_offset / sizeof(uint32_t)] = addr;
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Bound lazy import '%s' of module '%s' to %08X\n", sym.name, udynlink_get_module_name(p_mod), addr);
+    return addr;
+}
+
+// Point the LOT entry of the binder of a module with lazy imports (if any) to lazy_bind. The LOT entries of the
+// imports themselves point to their stubs (regular relocations).
+static udynlink_error_t set_lazy_binder(udynlink_module_t *p_mod) {
+    uint32_t size;
+    const uint32_t *p_lazy = get_ext_block(p_mod, UDYNLINK_EXT_TAG_LAZY_IMPORTS, &size);
+
+    if (p_lazy != NULL) {
+        if ((size < sizeof(uint32_t)) || (p_lazy[0] >= p_mod->p_header->num_lot)) {
+            return UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE;
+        }
+        ((uint32_t*)p_mod->lot_base)[p_lazy[0]] = (uint32_t)&lazy_bind;
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Module has %u lazy import(s)\n", (size / sizeof(uint32_t) - 1) / 2);
+    }
+    return UDYNLINK_OK;
+}
+
+// Returns 1 if the module image in p_image (a temporary handle) imports a symbol that isn't known to the host, but is
+// exported by one of the modules in p_pending (other than itself), 0 otherwise
+static int imports_from_pending(const udynlink_module_t *p_image, const udynlink_module_t *p_pending, uint32_t count) {
+    udynlink_sym_t sym, other;
+    uint32_t idx = 0;
+
+    if (get_module_flags(p_image) & UDYNLINK_SYMT_FLAG_ORDINALS) { // ordinal imports come only from the host
+        return 0;
+    }
+    while (get_sym_at(p_image, idx ++, &sym) != NULL) {
+        if ((sym.type != UDYNLINK_SYM_TYPE_EXTERN) || (udynlink_external_resolve_symbol(sym.name) != 0)) {
+            continue;
+        }
+        for (uint32_t i = 0; i < count; i ++) {
+            if ((p_pending + i != p_image) && (p_pending[i].p_header != NULL) && (find_sym(p_pending + i, sym.name, get_name_hash(sym.name), &other) != NULL) && (other.type == UDYNLINK_SYM_TYPE_EXPORTED)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Helpers - loading
+
+// Allocate RAM for a module or check the RAM region given by the caller (load_addr, load_size)
+static udynlink_error_t alloc_module_ram(udynlink_module_t *p_mod, void *load_addr, uint32_t load_size) {
+    uint32_t ram_size = udynlink_get_ram_size(p_mod);
+
+    if (ram_size > 0) { // is any RAM needed at all?
+        if (load_addr == NULL) { // RAM must be allocated
+            UDYNLINK_LOAD_CLR_FOREIGN_RAM(p_mod);
+            if ((p_mod->p_ram = udynlink_external_malloc(ram_size)) == NULL) {
+                return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+            }
+            UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Allocated %u bytes for module at %p\n", ram_size, p_mod->p_header);
+        } else { // check if the user-provided RAM region is large enough
+            UDYNLINK_LOAD_SET_FOREIGN_RAM(p_mod);
+            if (load_size < ram_size) {
+                return UDYNLINK_ERR_LOAD_RAM_LEN_LOW;
+            }
+            p_mod->p_ram = load_addr;
+        }
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "RAM area for module at %p is at %p (%u bytes)\n", p_mod->p_header, p_mod->p_ram, ram_size);
     } else {
-        // XIP mode: copy only data
-        memcpy(p_temp8, (const uint8_t*)base_addr + load_size + p_header->code_size, p_header->data_size);
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Copied data of module %p to RAM at %p (%u bytes)\n", base_addr, p_temp8, p_header->data_size);
+        p_mod->p_ram = NULL;
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Awesome! Module %p doesn't need any RAM\n", p_mod->p_header);
     }
+    // The LOT is at the start of the RAM, followed by .data and .bss, then by the code (or the whole module)
+    p_mod->lot_base = p_mod->ram_base;
+    p_mod->p_data = (uint8_t*)p_mod->p_ram + p_mod->p_header->num_lot * sizeof(uint32_t);
+    p_mod->p_code_ram = (uint8_t*)p_mod->p_ram + get_ram_code_offset(p_mod->p_header);
+    return UDYNLINK_OK;
+}
+
+// Returns the size of the given segment of a module (see udynlink_segment_t). The data of modules that access it
+// relative to r9 must follow the LOT, so it's part of the LOT segment. With split data, .fastdata follows the LOT too.
+static uint32_t get_segment_size(const udynlink_module_t *p_mod, udynlink_segment_t seg) {
+    const udynlink_module_header_t *p_header = p_mod->p_header;
+    uint32_t data_size = p_header->data_size + p_header->bss_size;
+    uint32_t fast_size = UDYNLINK_LOAD_IS_SPLIT_DATA(p_mod) ? get_section_size(p_mod, UDYNLINK_SECTION_FASTDATA) : 0;
+    int r9_data = (get_module_flags(p_mod) & UDYNLINK_SYMT_FLAG_R9_DATA) != 0;
+
+    switch (seg) {
+        case UDYNLINK_SEGMENT_LOT:
+            return p_header->num_lot * sizeof(uint32_t) + (r9_data ? data_size : fast_size);
+
+        case UDYNLINK_SEGMENT_DATA:
+            return r9_data ? 0 : data_size - fast_size;
+
+        default:
+            if (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_COPY_CODE) {
+                return p_header->code_size;
+            } else if (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_COPY_ALL) {
+                return get_code_offset_from_header(p_header) + p_header->code_size;
+            }
+            return get_section_size(p_mod, UDYNLINK_SECTION_RAMFUNC);
+    }
+}
 
-    // Zero out BSS
-    memset(get_data_pointer(p_mod) + p_header->data_size, 0, p_header->bss_size);
+// Allocate memory for a segment of a module in its region (with udynlink_external_malloc if it doesn't have one)
+static void *alloc_segment(const udynlink_module_t *p_mod, udynlink_segment_t seg, uint32_t size) {
+    const udynlink_region_t *p_region = p_mod->p_placement[seg];
+
+    return p_region == NULL ? udynlink_external_malloc(size) : p_region->p_alloc(p_region->p_ctx, size);
+}
+
+// Free the memory of a segment of a module (if it was allocated)
+static void free_segment(const udynlink_module_t *p_mod, udynlink_segment_t seg, void *p_mem) {
+    const udynlink_region_t *p_region = p_mod->p_placement[seg];
+
+    if ((p_mem == NULL) || (get_segment_size(p_mod, seg) == 0)) {
+        return;
+    }
+    if (p_region == NULL) {
+        udynlink_external_free(p_mem);
+    } else if (p_region->p_free != NULL) {
+        p_region->p_free(p_region->p_ctx, p_mem);
+    }
+}
+
+// Returns the address of the data segment of a module with placed segments (the start of .data, after .fastdata
+// with split data), or NULL if it wasn't allocated
+static uint8_t *get_data_segment(const udynlink_module_t *p_mod) {
+    if (p_mod->p_data == NULL) { // the allocation failed (p_data is adjusted for split data only after it succeeds)
+        return NULL;
+    }
+    return p_mod->p_data + (UDYNLINK_LOAD_IS_SPLIT_DATA(p_mod) ? get_section_size(p_mod, UDYNLINK_SECTION_FASTDATA) : 0);
+}
+
+// Allocate the segments of a module in the regions given by p_placement. If the module has .fastdata, it goes in the
+// LOT segment (right after the LOT) and the rest of the data in the data segment (split data). This isn't possible
+// when the data is accessed relative to r9 (all of it is in the LOT segment anyway) or is compressed (it's
+// decompressed in a single block).
+static udynlink_error_t alloc_module_placed(udynlink_module_t *p_mod, const udynlink_region_t * const *p_placement) {
+    uint32_t size, fast_size = get_section_size(p_mod, UDYNLINK_SECTION_FASTDATA);
+
+    UDYNLINK_LOAD_CLR_FOREIGN_RAM(p_mod);
+    p_mod->p_placement = p_placement;
+    if ((fast_size > 0) && !(get_module_flags(p_mod) & UDYNLINK_SYMT_FLAG_R9_DATA) && (get_ext_block(p_mod, UDYNLINK_EXT_TAG_COMPRESSION, NULL) == NULL)) {
+        UDYNLINK_LOAD_SET_SPLIT_DATA(p_mod);
+    }
+    if (((size = get_segment_size(p_mod, UDYNLINK_SEGMENT_LOT)) > 0) && ((p_mod->lot_base = (uint32_t)alloc_segment(p_mod, UDYNLINK_SEGMENT_LOT, size)) == 0)) {
+        return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+    }
+    if ((size = get_segment_size(p_mod, UDYNLINK_SEGMENT_DATA)) == 0) { // the data (if any) is in the LOT segment
+        p_mod->p_data = (uint8_t*)p_mod->lot_base + p_mod->p_header->num_lot * sizeof(uint32_t);
+    } else if ((p_mod->p_data = (uint8_t*)alloc_segment(p_mod, UDYNLINK_SEGMENT_DATA, size)) == NULL) {
+        return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+    } else if (UDYNLINK_LOAD_IS_SPLIT_DATA(p_mod)) { // p_data is where .data would start if it wasn't split
+        p_mod->p_data -= fast_size;
+    }
+    if (((size = get_segment_size(p_mod, UDYNLINK_SEGMENT_CODE)) > 0) && ((p_mod->p_code_ram = (uint8_t*)alloc_segment(p_mod, UDYNLINK_SEGMENT_CODE, size)) == NULL)) {
+        return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+    }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Segments of module at %p: LOT at %08X, data at %p, code at %p\n", p_mod->p_header, p_mod->lot_base, p_mod->p_data, p_mod->p_code_ram);
+    return UDYNLINK_OK;
+}
+
+// Free the RAM of a module (unless it was given by the caller)
+static void free_module_ram(udynlink_module_t *p_mod) {
+    if (p_mod->p_placement != NULL) { // the code segment is freed last, since it can hold the module header
+        free_segment(p_mod, UDYNLINK_SEGMENT_LOT, (void*)p_mod->lot_base);
+        free_segment(p_mod, UDYNLINK_SEGMENT_DATA, get_data_segment(p_mod));
+        free_segment(p_mod, UDYNLINK_SEGMENT_CODE, p_mod->p_code_ram);
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Deallocated the segments of module %p\n", p_mod);
+    } else if ((p_mod->p_ram != NULL) && !UDYNLINK_LOAD_IS_FOREIGN_RAM(p_mod)) {
+        udynlink_external_free(p_mod->p_ram);
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Deallocated memory area at %p\n", p_mod->p_ram);
+    }
+}
+
+// Check that a module can be loaded and make room for it in the indexes. Only the header of the module (including
+// the relocations and the symbol table) needs to be accessible.
+static udynlink_error_t check_module(udynlink_module_t *p_mod) {
+    udynlink_error_t res;
+
+    // Compressed code can't be executed in place
+    if ((get_ext_block(p_mod, UDYNLINK_EXT_TAG_COMPRESSION, NULL) != NULL) && (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_XIP)) {
+        return UDYNLINK_ERR_LOAD_UNABLE_TO_XIP;
+    }
+
+    // Check if a module with a duplicated name already exists
+    if (find_module(udynlink_get_module_name(p_mod), p_mod) != NULL) {
+        return UDYNLINK_ERR_LOAD_DUPLICATE_NAME;
+    }
+
+    // Make sure that the module's code ranges can be added to the code range index
+    if ((res = reserve_code_ranges(get_num_code_ranges(p_mod))) != UDYNLINK_OK) {
+        return res;
+    }
+
+    // Build the symbol filter and make sure that the module's exports can be added to the export index
+    return reserve_exports(build_sym_filter(p_mod));
+}
+
+// Zero out .bss, except for .noinit at its end (which keeps its content between loads of the module at the same address)
+static void zero_bss(const udynlink_module_t *p_mod) {
+    const udynlink_module_header_t *p_header = p_mod->p_header;
+    uint32_t noinit_size = get_section_size(p_mod, UDYNLINK_SECTION_NOINIT);
+
+    if (noinit_size < p_header->bss_size) {
+        memset(get_data_pointer(p_mod) + p_header->data_size, 0, p_header->bss_size - noinit_size);
+    }
+}
+
+// Relocate a module whose code and data are in place
+static udynlink_error_t relocate_module(udynlink_module_t *p_mod) {
+    const udynlink_module_header_t *p_header = p_mod->p_header;
+    udynlink_error_t res;
+    udynlink_sym_t sym;
+    uint32_t first_rel = 0, size;
+
+    zero_bss(p_mod);
 
     // Process relocations
     // TODO: find the correct condition for the error "unable to execute in place"
     const uint32_t *p_rels = get_relocs_pointer(p_mod);
-    uint32_t *p_lot = (uint32_t*)ram_addr;
+    uint32_t *p_lot = (uint32_t*)p_mod->lot_base;
     uint32_t *p_data = (uint32_t*)get_data_pointer(p_mod);
     UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "LOT base: %p, .data starts at %p, .code starts at %p\n", p_lot, p_data, get_code_pointer(p_mod));
+    // If the module was prelinked for the addresses of its RAM (the LOT, followed by the data) and code, .data is already
+    // relocated and the LOT is in the image. The relocations of the symbols defined in the module come first, so only
+    // the rest must be applied.
+    const uint32_t *p_prelink = get_ext_block(p_mod, UDYNLINK_EXT_TAG_PRELINK, &size);
+    if ((p_prelink != NULL) && !UDYNLINK_LOAD_IS_FLASH_LOT(p_mod) && (p_prelink[0] == p_mod->lot_base) && ((uint32_t*)p_data == p_lot + p_header->num_lot) &&
+        (p_prelink[1] == (uint32_t)get_code_pointer(p_mod))) {
+        if ((size != (3 + p_header->num_lot) * sizeof(uint32_t)) || (p_prelink[2] > p_header->num_rels)) {
+            return UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE;
+        }
+        memcpy(p_lot, p_prelink + 3, p_header->num_lot * sizeof(uint32_t));
+        first_rel = p_prelink[2];
+        p_rels += 2 * first_rel;
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Module is prelinked for this address, skipped %u relocation(s)\n", first_rel);
+    }
     // Read and apply each (lot_offset, symt_offset) pair in turn
-    for (uint32_t i = 0; i < p_header->num_rels; i ++) {
+    for (uint32_t i = first_rel; i < p_header->num_rels; i ++) {
         uint32_t lot_offset = *p_rels ++;
         uint32_t symt_offset = *p_rels ++;
         if (get_sym_at(p_mod, symt_offset, &sym) == NULL) { // symbol table offset is out of range, shouldn't happen
-            res = UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE;
-            goto exit;
+            return UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE;
         }
         // Relocations in LOT and .data are encoded in the same way, they can be differentiated based on the value of lot_offset.
         // If lot_offset is larger than or equal to the number of LOT entries, this relocation applies to data, not to LOT.
-        uint32_t *p_rel_location = (lot_offset < p_header->num_lot) ? p_lot + lot_offset : p_data + lot_offset - p_header->num_lot;
+        uint32_t *p_rel_location = (lot_offset < p_header->num_lot) ? p_lot + lot_offset : (uint32_t*)get_data_address(p_mod, (lot_offset - p_header->num_lot) * sizeof(uint32_t));
         switch (sym.type) {
             case UDYNLINK_SYM_TYPE_LOCAL:
             case UDYNLINK_SYM_TYPE_EXPORTED:
@@ -305,50 +1309,634 @@ udynlink_module_t *udynlink_load_module(const void *base_addr, void *load_addr,
             case UDYNLINK_SYM_TYPE_EXTERN:
                 UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Applying extern relocation for symbol at index %u, name=%s at lot_offset=%u\n", symt_offset, sym.name, lot_offset);
                 // TODO: this needs a separate step (look in the static symbols of the running program)
-                uint32_t sym_addr = udynlink_external_resolve_symbol(sym.name);
+                const udynlink_module_t *p_dep;
+                uint32_t sym_addr = resolve_extern(p_mod, symt_offset, &sym, &p_dep);
                 if (sym_addr > 0) {
                     *p_rel_location = sym_addr;
+                    if ((p_dep != NULL) && ((res = add_dependency(p_mod, p_dep)) != UDYNLINK_OK)) {
+                        return res;
+                    }
                 } else {
                     UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Unable to resolve relocation for extern symbol '%s'\n", sym.name);
-                    res = UDYNLINK_ERR_LOAD_UNKNOWN_SYMBOL;
-                    goto exit;
+                    return UDYNLINK_ERR_LOAD_UNKNOWN_SYMBOL;
                 }
                 break;
 
             case UDYNLINK_SYM_TYPE_NAME: // no relocations should be emitted against the name of the module
-                res = UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE;
-                goto exit;
+                return UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE;
         }
     }
+    return UDYNLINK_OK;
+}
+
+// Copy .ramfunc of a module in XIP mode (from the end of its code in the image) to RAM
+static void copy_ramfunc(udynlink_module_t *p_mod) {
+    uint32_t ramfunc_size = get_section_size(p_mod, UDYNLINK_SECTION_RAMFUNC);
+
+    if ((UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_XIP) && (ramfunc_size > 0)) {
+        memcpy(p_mod->p_code_ram, get_code_pointer(p_mod) + p_mod->p_header->code_size - ramfunc_size, ramfunc_size);
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Copied .ramfunc of module %p to RAM at %p (%u bytes)\n", p_mod->p_header, p_mod->p_code_ram, ramfunc_size);
+    }
+}
+
+// Add a module that is ready to run to the indexes
+static void register_module(udynlink_module_t *p_mod) {
+    add_code_range(p_mod, (uint32_t)get_code_pointer(p_mod), p_mod->p_header->code_size);
+    if (get_num_code_ranges(p_mod) > 1) { // .ramfunc runs from RAM
+        add_code_range(p_mod, (uint32_t)p_mod->p_code_ram, get_section_size(p_mod, UDYNLINK_SECTION_RAMFUNC));
+    }
+    index_module(p_mod);
+    index_exports(p_mod);
+    for (uint32_t i = 0; i < p_mod->num_deps; i ++) {
+        p_mod->p_deps[i]->ref_count ++;
+    }
+}
+
+// Relocate a module whose code and data are in place and add it to the indexes
+static udynlink_error_t link_module(udynlink_module_t *p_mod) {
+    udynlink_error_t res;
+
+    if ((res = relocate_module(p_mod)) != UDYNLINK_OK) {
+        return res;
+    }
+
+    // Setup the direct export wrappers
+    if ((res = set_lot_slots(p_mod, p_mod)) != UDYNLINK_OK) {
+        return res;
+    }
+
+    // Setup the binder of the lazy imports
+    if ((res = set_lazy_binder(p_mod)) != UDYNLINK_OK) {
+        return res;
+    }
 
     // All done
+    register_module(p_mod);
+    return UDYNLINK_OK;
+}
+
+// Cleanup after a module that couldn't be loaded (free its memory and its handle)
+static void discard_module(udynlink_module_t *p_mod, udynlink_error_t res) {
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)res]);
+    if (p_mod == NULL) {
+        return;
+    }
+    free_module_ram(p_mod);
+    if (p_mod->p_deps != NULL) { // free the dependency list
+        udynlink_external_free(p_mod->p_deps);
+    }
+    mark_module_free(p_mod); // mark entry in module table as "free"
+}
+
+// Read the next "size" bytes of a streamed image to p_dst, decompressing them if the image is compressed
+// (comp_size is the size of the LZ4 block in the image, 0 if not compressed).
+static udynlink_error_t read_stream(udynlink_read_func_t p_read, void *p_ctx, uint8_t *p_dst, uint32_t size, uint32_t comp_size) {
+    uint8_t buf[UDYNLINK_STREAM_BUFFER_SIZE];
+    lz4_src_t src = {buf, buf, comp_size, p_read, p_ctx, buf, 0};
+
+    if (comp_size == 0) {
+        return (size == 0) || p_read(p_ctx, p_dst, size) ? UDYNLINK_OK : UDYNLINK_ERR_LOAD_READ_ERROR;
+    } else if (!lz4_decompress(&src, p_dst, size)) {
+        return src.error ? UDYNLINK_ERR_LOAD_READ_ERROR : UDYNLINK_ERR_LOAD_BAD_COMPRESSED_DATA;
+    }
+    return UDYNLINK_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public interface
+
+// Load a module from a memory mapped image, in a single RAM area (load_addr, load_size) or with its segments placed in
+// different RAM regions (p_placement not NULL)
+static udynlink_module_t *load_module(const void *base_addr, void *load_addr, uint32_t load_size, const udynlink_region_t * const *p_placement, udynlink_load_mode_t load_mode, udynlink_error_t *p_error) {
+    udynlink_module_t *p_mod = NULL;
+    udynlink_error_t res = UDYNLINK_OK;
+    const udynlink_module_header_t *p_header = (const udynlink_module_header_t*)base_addr;
+
+    // Find an empty space in the module table
+    if((p_mod = get_next_free_module()) == NULL) {
+        res = UDYNLINK_ERR_LOAD_NO_MORE_HANDLES;
+        goto exit;
+    }
+
+    // Setup the module structure. Depending on the copy mode, we might need to rewrite it later.
+    p_mod->p_header = p_header;
+    UDYNLINK_LOAD_SET_MODE(p_mod, load_mode);
+
+    // Check signature
+    if (p_header->sign != UDYNLINK_MODULE_SIGN) {
+        res = UDYNLINK_ERR_LOAD_INVALID_SIGN;
+        goto exit;
+    }
+
+    // Check load mode
+    if ((uint32_t)load_mode > (uint32_t)_UDYNLINK_LOAD_MODE_LAST) {
+        res = UDYNLINK_ERR_LOAD_INVALID_MODE;
+        goto exit;
+    }
+
+    if ((res = check_module(p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Processing module at %p named '%s' with load mode %d\n", base_addr, udynlink_get_module_name(p_mod), (int)load_mode);
+
+    // Allocate RAM or check given RAM region, as needed
+    if ((res = p_placement != NULL ? alloc_module_placed(p_mod, p_placement) : alloc_module_ram(p_mod, load_addr, load_size)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    // Copy to RAM as needed: .data to its place (after the LOT in a single RAM area) and the code (or the whole module)
+    // to the code segment. In compressed images, the code and the data are LZ4 blocks, which are decompressed directly
+    // to their place in RAM.
+    const uint32_t *p_comp = get_ext_block(p_mod, UDYNLINK_EXT_TAG_COMPRESSION, NULL);
+    uint8_t *p_temp8 = get_data_pointer(p_mod);
+    // Reuse "load_size" (since it's not used anymore) to hold the offset to code, according to the header.
+    load_size = get_code_offset_from_header(p_header);
+    const uint8_t *p_src_code = (const uint8_t*)base_addr + load_size;
+    const uint8_t *p_src_data = p_src_code + (p_comp != NULL ? p_comp[0] : p_header->code_size);
+    if (p_comp == NULL) { // with split data, .fastdata (at the start of .data) is copied separately
+        uint32_t fast_size = UDYNLINK_LOAD_IS_SPLIT_DATA(p_mod) ? get_section_size(p_mod, UDYNLINK_SECTION_FASTDATA) : 0;
+        memcpy(get_data_address(p_mod, 0), p_src_data, fast_size);
+        memcpy(p_temp8 + fast_size, p_src_data + fast_size, p_header->data_size - fast_size);
+    } else if (!lz4_decompress_mem(p_src_data, p_comp[1], p_temp8, p_header->data_size)) {
+        res = UDYNLINK_ERR_LOAD_BAD_COMPRESSED_DATA;
+        goto exit;
+    }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Copied data of module %p to RAM at %p (%u bytes)\n", base_addr, p_temp8, p_header->data_size);
+    p_temp8 = p_mod->p_code_ram;
+    if (load_mode == UDYNLINK_LOAD_MODE_COPY_ALL) {
+        // We need to copy the rest of the module to RAM (header, symbol table, relocs, code)
+        memcpy(p_temp8, base_addr, load_size);
+        p_temp8 += load_size;
+    }
+    if (load_mode != UDYNLINK_LOAD_MODE_XIP) {
+        if (p_comp == NULL) {
+            memcpy(p_temp8, p_src_code, p_header->code_size);
+        } else if (!lz4_decompress_mem(p_src_code, p_comp[0], p_temp8, p_header->code_size)) {
+            res = UDYNLINK_ERR_LOAD_BAD_COMPRESSED_DATA;
+            goto exit;
+        }
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Copied code of module %p to RAM at %p (%u bytes)\n", base_addr, p_temp8, p_header->code_size);
+    }
+    if (load_mode == UDYNLINK_LOAD_MODE_COPY_ALL) {
+        // Since we copied everything, move the pointer to the header to RAM, since the original (base_addr) might be freed eventually.
+        p_mod->p_header = (const udynlink_module_header_t*)(p_temp8 - load_size);
+    }
+    copy_ramfunc(p_mod);
+
+    // Relocate the module
+    if ((res = link_module(p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
     UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Done loading module at %p\n", base_addr);
 
 exit:
     write_error(p_error, res);
     if (res != UDYNLINK_OK) { // there's an error, so cleanup allocated structures and memory
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)res]);
-        if ((p_mod->p_ram != NULL) && !UDYNLINK_LOAD_IS_FOREIGN_RAM(p_mod)) { // free allocated memory
-            udynlink_external_free(p_mod->p_ram);
-            UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Deallocated memory area at %p\n", p_mod->p_ram);
+        discard_module(p_mod, res);
+    }
+    return res == UDYNLINK_OK ? p_mod : NULL;
+}
+
+udynlink_module_t *udynlink_load_module(const void *base_addr, void *load_addr, uint32_t load_size, udynlink_load_mode_t load_mode, udynlink_error_t *p_error) {
+    return load_module(base_addr, load_addr, load_size, NULL, load_mode, p_error);
+}
+
+udynlink_module_t *udynlink_load_module_placed(const void *base_addr, const udynlink_region_t * const *p_placement, udynlink_load_mode_t load_mode, udynlink_error_t *p_error) {
+    return load_module(base_addr, NULL, 0, p_placement, load_mode, p_error);
+}
+
+udynlink_module_t *udynlink_load_module_stream(udynlink_read_func_t p_read, void *p_ctx, void *load_addr, uint32_t load_size, udynlink_error_t *p_error) {
+    udynlink_module_t *p_mod = NULL;
+    udynlink_error_t res = UDYNLINK_OK;
+    udynlink_module_header_t header;
+
+    // Find an empty space in the module table
+    if((p_mod = get_next_free_module()) == NULL) {
+        res = UDYNLINK_ERR_LOAD_NO_MORE_HANDLES;
+        goto exit;
+    }
+
+    // Read the fixed part of the header, which is enough to find how much RAM the module needs. The module is loaded
+    // like in COPY_ALL mode, since its image isn't accessible after this call returns.
+    if (!p_read(p_ctx, &header, sizeof(header))) {
+        res = UDYNLINK_ERR_LOAD_READ_ERROR;
+        goto exit;
+    }
+    if (header.sign != UDYNLINK_MODULE_SIGN) {
+        res = UDYNLINK_ERR_LOAD_INVALID_SIGN;
+        goto exit;
+    }
+    p_mod->p_header = &header;
+    UDYNLINK_LOAD_SET_MODE(p_mod, UDYNLINK_LOAD_MODE_COPY_ALL);
+    if ((res = alloc_module_ram(p_mod, load_addr, load_size)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    // Read the rest of the header (relocations and symbol table) after .bss, then check the module
+    uint8_t *p_temp8 = p_mod->p_code_ram;
+    load_size = get_code_offset_from_header(&header);
+    memcpy(p_temp8, &header, sizeof(header));
+    p_mod->p_header = (const udynlink_module_header_t*)p_temp8;
+    if ((res = read_stream(p_read, p_ctx, p_temp8 + sizeof(header), load_size - sizeof(header), 0)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    if ((res = check_module(p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Streaming module named '%s' to RAM at %p\n", udynlink_get_module_name(p_mod), p_mod->p_ram);
+
+    // The code and the data follow in the image (LZ4 blocks in compressed images), in the same order as in RAM
+    const uint32_t *p_comp = get_ext_block(p_mod, UDYNLINK_EXT_TAG_COMPRESSION, NULL);
+    if ((res = read_stream(p_read, p_ctx, p_temp8 + load_size, header.code_size, p_comp != NULL ? p_comp[0] : 0)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    p_temp8 = get_data_pointer(p_mod);
+    if ((res = read_stream(p_read, p_ctx, p_temp8, header.data_size, p_comp != NULL ? p_comp[1] : 0)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    // Relocate the module
+    if ((res = link_module(p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Done loading module at %p\n", p_mod->p_header);
+
+exit:
+    write_error(p_error, res);
+    if (res != UDYNLINK_OK) { // there's an error, so cleanup allocated structures and memory
+        discard_module(p_mod, res);
+    }
+    return res == UDYNLINK_OK ? p_mod : NULL;
+}
+
+#if UDYNLINK_FLASH_LOT
+udynlink_error_t udynlink_install_module(const void *base_addr, void *p_dest, void *ram_addr, uint32_t ram_size) {
+    udynlink_module_t mod, *p_mod = &mod;
+    const udynlink_module_header_t *p_header = (const udynlink_module_header_t*)base_addr;
+    installed_header_t *p_inst = NULL;
+    const udynlink_module_t *p_dep;
+    udynlink_error_t res = UDYNLINK_OK;
+    udynlink_sym_t sym;
+    uint32_t size, addr;
+
+    // The module is relocated in a temporary handle, with the LOT in a RAM buffer and the data at its final address
+    memset(p_mod, 0, sizeof(udynlink_module_t));
+    p_mod->p_header = p_header;
+    p_mod->p_ram = ram_addr;
+    p_mod->p_data = (uint8_t*)ram_addr;
+    p_mod->p_code_ram = (uint8_t*)ram_addr + p_header->data_size + p_header->bss_size; // .ramfunc (if any) follows .bss
+    UDYNLINK_LOAD_SET_MODE(p_mod, UDYNLINK_LOAD_MODE_XIP);
+    UDYNLINK_LOAD_SET_FOREIGN_RAM(p_mod);
+    UDYNLINK_LOAD_SET_FLASH_LOT(p_mod);
+    if (p_header->sign != UDYNLINK_MODULE_SIGN) {
+        res = UDYNLINK_ERR_LOAD_INVALID_SIGN;
+        goto exit;
+    }
+    if (get_module_flags(p_mod) & UDYNLINK_SYMT_FLAG_R9_DATA) { // the data must follow the LOT
+        res = UDYNLINK_ERR_INSTALL_UNSUPPORTED_MODULE;
+        goto exit;
+    }
+    if (get_ext_block(p_mod, UDYNLINK_EXT_TAG_COMPRESSION, NULL) != NULL) {
+        res = UDYNLINK_ERR_LOAD_UNABLE_TO_XIP;
+        goto exit;
+    }
+    if (ram_size < udynlink_get_ram_size(p_mod)) {
+        res = UDYNLINK_ERR_LOAD_RAM_LEN_LOW;
+        goto exit;
+    }
+    if ((p_inst = (installed_header_t*)udynlink_external_malloc(sizeof(installed_header_t) + p_header->num_lot * sizeof(uint32_t))) == NULL) {
+        res = UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+        goto exit;
+    }
+    memset(p_inst + 1, 0, p_header->num_lot * sizeof(uint32_t));
+    p_mod->lot_base = (uint32_t)(p_inst + 1);
+    memcpy(ram_addr, get_code_pointer(p_mod) + p_header->code_size, p_header->data_size);
+    if ((res = relocate_module(p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    // The LOT can't be changed after it's written to flash, so the lazy imports are bound now
+    const uint32_t *p_lazy = get_ext_block(p_mod, UDYNLINK_EXT_TAG_LAZY_IMPORTS, &size);
+    for (uint32_t i = 1; (p_lazy != NULL) && (i + 1 < size / sizeof(uint32_t)); i += 2) {
+        if ((p_lazy[i] >= p_header->num_lot) || (get_sym_at(p_mod, p_lazy[i + 1], &sym) == NULL) || ((addr = resolve_extern(p_mod, p_lazy[i + 1], &sym, &p_dep)) == 0)) {
+            res = UDYNLINK_ERR_LOAD_UNKNOWN_SYMBOL;
+            goto exit;
         }
-        if (p_mod != NULL) { // mark entry in module table as "free"
-            mark_module_free(p_mod);
+        if ((p_dep != NULL) && ((res = add_dependency(p_mod, p_dep)) != UDYNLINK_OK)) {
+            goto exit;
         }
+        ((uint32_t*)p_mod->lot_base)[p_lazy[i]] = addr;
+    }
+    // Other modules can be loaded at different addresses, so only the firmware can export symbols to installed modules
+    if (p_mod->num_deps > 0) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Installed modules can't import symbols from other modules\n");
+        res = UDYNLINK_ERR_INSTALL_UNSUPPORTED_MODULE;
+        goto exit;
+    }
+
+    // Write the installed module to flash: header, LOT and .data
+    p_inst->sign = UDYNLINK_INSTALLED_SIGN;
+    p_inst->image = (uint32_t)base_addr;
+    p_inst->ram = (uint32_t)ram_addr;
+    p_inst->num_lot = p_header->num_lot;
+    size = sizeof(installed_header_t) + p_header->num_lot * sizeof(uint32_t);
+    if (!udynlink_external_flash_write(p_dest, p_inst, size) ||
+        ((p_header->data_size > 0) && !udynlink_external_flash_write((uint8_t*)p_dest + size, ram_addr, p_header->data_size))) {
+        res = UDYNLINK_ERR_INSTALL_FLASH_WRITE;
+        goto exit;
+    }
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Installed module '%s' at %p (LOT at %p, %u bytes of RAM at %p)\n", udynlink_get_module_name(p_mod), p_dest,
+                   (uint8_t*)p_dest + sizeof(installed_header_t), udynlink_get_ram_size(p_mod), ram_addr);
+
+exit:
+    if (res != UDYNLINK_OK) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)res]);
+    }
+    if (p_inst != NULL) {
+        udynlink_external_free(p_inst);
+    }
+    if (p_mod->p_deps != NULL) {
+        udynlink_external_free(p_mod->p_deps);
+    }
+    return res;
+}
+#endif // #if UDYNLINK_FLASH_LOT
+
+uint32_t udynlink_get_installed_size(const void *base_addr) {
+    const udynlink_module_header_t *p_header = (const udynlink_module_header_t*)base_addr;
+
+    return sizeof(installed_header_t) + p_header->num_lot * sizeof(uint32_t) + p_header->data_size;
+}
+
+udynlink_module_t *udynlink_load_installed_module(const void *p_installed, udynlink_error_t *p_error) {
+    const installed_header_t *p_inst = (const installed_header_t*)p_installed;
+    const udynlink_module_header_t *p_header = (const udynlink_module_header_t*)p_inst->image;
+    udynlink_module_t *p_mod = NULL;
+    udynlink_error_t res = UDYNLINK_OK;
+
+    // Find an empty space in the module table
+    if((p_mod = get_next_free_module()) == NULL) {
+        res = UDYNLINK_ERR_LOAD_NO_MORE_HANDLES;
+        goto exit;
+    }
+
+    // Check that the installed module matches its image
+    if ((p_inst->sign != UDYNLINK_INSTALLED_SIGN) || (p_header->sign != UDYNLINK_MODULE_SIGN) || (p_header->num_lot != p_inst->num_lot)) {
+        res = UDYNLINK_ERR_INSTALL_INVALID;
+        goto exit;
+    }
+    p_mod->p_header = p_header;
+    p_mod->p_ram = (void*)p_inst->ram;
+    p_mod->p_data = (uint8_t*)p_inst->ram;
+    p_mod->p_code_ram = p_mod->p_data + p_header->data_size + p_header->bss_size;
+    p_mod->lot_base = (uint32_t)(p_inst + 1);
+    UDYNLINK_LOAD_SET_MODE(p_mod, UDYNLINK_LOAD_MODE_XIP);
+    UDYNLINK_LOAD_SET_FOREIGN_RAM(p_mod);
+    UDYNLINK_LOAD_SET_FLASH_LOT(p_mod);
+    if ((res = check_module(p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    // The LOT and .data were relocated when the module was installed, so .data (and .ramfunc) are just copied
+    memcpy(p_mod->p_ram, (const uint32_t*)(p_inst + 1) + p_inst->num_lot, p_header->data_size);
+    zero_bss(p_mod);
+    copy_ramfunc(p_mod);
+    if ((res = set_lot_slots(p_mod, p_mod)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    register_module(p_mod);
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Loaded installed module '%s' (LOT at %08X, data at %p)\n", udynlink_get_module_name(p_mod), p_mod->lot_base, p_mod->p_ram);
+
+exit:
+    write_error(p_error, res);
+    if (res != UDYNLINK_OK) { // there's an error, so cleanup allocated structures and memory
+        discard_module(p_mod, res);
     }
     return res == UDYNLINK_OK ? p_mod : NULL;
 }
 
+udynlink_module_t *udynlink_create_instance(udynlink_module_t *p_mod, void *load_addr, uint32_t load_size, udynlink_error_t *p_error) {
+    udynlink_module_t *p_inst = NULL;
+    udynlink_error_t res = UDYNLINK_OK;
+
+    if ((p_mod == NULL) || (p_mod->p_header == NULL)) {
+        res = UDYNLINK_ERR_INVALID_MODULE;
+        goto exit;
+    }
+    if (p_mod->p_shared != NULL) { // all the instances share the code of the module
+        p_mod = p_mod->p_shared;
+    }
+    // The initial .data of the instance is read from the module image, which isn't kept in COPY_ALL mode
+    if (UDYNLINK_LOAD_GET_MODE(p_mod) == UDYNLINK_LOAD_MODE_COPY_ALL) {
+        res = UDYNLINK_ERR_LOAD_INVALID_MODE;
+        goto exit;
+    }
+
+    // Find an empty space in the module table
+    if((p_inst = get_next_free_module()) == NULL) {
+        res = UDYNLINK_ERR_LOAD_NO_MORE_HANDLES;
+        goto exit;
+    }
+
+    // The instance is loaded like the module in XIP mode (only the LOT, .data and .bss are in RAM), but its code
+    // pointer is the code of the module
+    const udynlink_module_header_t *p_header = p_mod->p_header;
+    p_inst->p_header = p_header;
+    p_inst->p_shared = p_mod;
+    UDYNLINK_LOAD_SET_MODE(p_inst, UDYNLINK_LOAD_MODE_XIP);
+    build_sym_filter(p_inst);
+    if ((res = alloc_module_ram(p_inst, load_addr, load_size)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    const uint32_t *p_comp = get_ext_block(p_inst, UDYNLINK_EXT_TAG_COMPRESSION, NULL);
+    const uint8_t *p_src_data = (const uint8_t*)p_header + get_code_offset_from_header(p_header) + (p_comp != NULL ? p_comp[0] : p_header->code_size);
+    if (p_comp == NULL) {
+        memcpy(get_data_pointer(p_inst), p_src_data, p_header->data_size);
+    } else if (!lz4_decompress_mem(p_src_data, p_comp[1], get_data_pointer(p_inst), p_header->data_size)) {
+        res = UDYNLINK_ERR_LOAD_BAD_COMPRESSED_DATA;
+        goto exit;
+    }
+
+    // Relocate the instance (its LOT points to its own data and to the shared code)
+    if ((res = relocate_module(p_inst)) != UDYNLINK_OK) {
+        goto exit;
+    }
+    if ((res = set_lazy_binder(p_inst)) != UDYNLINK_OK) {
+        goto exit;
+    }
+
+    // The instance isn't indexed, it's only added to the list of instances of the module
+    for (uint32_t i = 0; i < p_inst->num_deps; i ++) {
+        p_inst->p_deps[i]->ref_count ++;
+    }
+    p_mod->ref_count ++;
+    p_inst->p_next_instance = p_mod->p_next_instance;
+    p_mod->p_next_instance = p_inst;
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Created instance of module '%s' at %p (LOT at %08X)\n", udynlink_get_module_name(p_mod), p_inst, p_inst->lot_base);
+
+exit:
+    write_error(p_error, res);
+    if (res != UDYNLINK_OK) { // there's an error, so cleanup allocated structures and memory
+        discard_module(p_inst, res);
+    }
+    return res == UDYNLINK_OK ? p_inst : NULL;
+}
+
+udynlink_module_t *udynlink_select_instance(udynlink_module_t *p_inst) {
+    udynlink_module_t *p_mod, *p_prev;
+    uint32_t idx;
+
+    if ((p_inst == NULL) || (p_inst->p_header == NULL)) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)UDYNLINK_ERR_INVALID_MODULE]);
+        return NULL;
+    }
+    p_mod = p_inst->p_shared != NULL ? p_inst->p_shared : p_inst;
+    if ((idx = find_code_range(p_mod, 0)) == UDYNLINK_NO_RANGE) {
+        return NULL;
+    }
+    // The code ranges of the module hold the LOT base of the selected instance (used by udynlink_get_lot_base)
+    for (p_prev = p_mod; (p_prev != NULL) && (p_prev->lot_base != code_ranges[idx].lot_base); p_prev = p_prev->p_next_instance);
+    for (; idx != UDYNLINK_NO_RANGE; idx = find_code_range(p_mod, idx + 1)) {
+        code_ranges[idx].lot_base = p_inst->lot_base;
+    }
+    set_lot_slots(p_mod, p_inst); // can't fail, the module was already loaded with the same LOT slots
+    return p_prev;
+}
+
+uint32_t udynlink_get_instance_symbol(udynlink_module_t *p_inst, const char *name) {
+    udynlink_thunk_t *p_thunk;
+    udynlink_sym_t sym;
+    const uint32_t *p_bodies;
+    uint32_t size, body, i;
+
+    if ((p_inst == NULL) || (p_inst->p_header == NULL) || (find_sym(p_inst, name, get_name_hash(name), &sym) == NULL) || (sym.type != UDYNLINK_SYM_TYPE_EXPORTED)) {
+        return 0;
+    }
+    // Data symbols are in the RAM of the instance
+    if (sym.location != UDYNLINK_SYM_LOCATION_CODE) {
+        return offset_sym(p_inst, &sym)->val;
+    }
+    // Functions without an export wrapper don't depend on r9, so they don't need an entry point
+    p_bodies = get_ext_block(p_inst, UDYNLINK_EXT_TAG_EXPORT_BODIES, &size);
+    for (i = 0; (p_bodies != NULL) && (i + 1 < size / sizeof(uint32_t)) && (p_bodies[i] != sym.val); i += 2);
+    if ((p_bodies == NULL) || (i + 1 >= size / sizeof(uint32_t))) {
+        return offset_sym(p_inst, &sym)->val;
+    }
+    body = get_code_address(p_inst, p_bodies[i + 1]);
+    for (p_thunk = p_inst->p_thunks; p_thunk != NULL; p_thunk = p_thunk->p_next) {
+        if (p_thunk->body == body) {
+            return (uint32_t)p_thunk | 1;
+        }
+    }
+    if ((p_thunk = (udynlink_thunk_t*)udynlink_external_malloc(sizeof(udynlink_thunk_t))) == NULL) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)UDYNLINK_ERR_LOAD_OUT_OF_MEMORY]);
+        return 0;
+    }
+    memcpy(p_thunk->code, thunk_code, sizeof(thunk_code));
+    p_thunk->lot_base = p_inst->lot_base;
+    p_thunk->body = body;
+    p_thunk->p_next = p_inst->p_thunks;
+    p_inst->p_thunks = p_thunk;
+    UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Entry point of '%s' for the LOT at %08X is at %p\n", name, p_inst->lot_base, p_thunk);
+    return (uint32_t)p_thunk | 1;
+}
+
+udynlink_error_t udynlink_load_module_set(const void * const *p_images, uint32_t count, udynlink_load_mode_t load_mode, udynlink_module_t **p_mods) {
+    udynlink_module_t *p_pending;
+    udynlink_error_t res = UDYNLINK_OK;
+    uint32_t loaded = 0, progress = 1, i;
+
+    if (count == 0) {
+        return UDYNLINK_OK;
+    }
+    // Temporary handles for the images that aren't loaded yet (a handle is cleared after its image is loaded)
+    if ((p_pending = (udynlink_module_t*)udynlink_external_malloc(count * sizeof(udynlink_module_t))) == NULL) {
+        return UDYNLINK_ERR_LOAD_OUT_OF_MEMORY;
+    }
+    for (i = 0; i < count; i ++) {
+        memset(p_pending + i, 0, sizeof(udynlink_module_t));
+        p_pending[i].p_header = (const udynlink_module_header_t*)p_images[i];
+        p_mods[i] = NULL;
+        if (p_pending[i].p_header->sign != UDYNLINK_MODULE_SIGN) {
+            res = UDYNLINK_ERR_LOAD_INVALID_SIGN;
+            goto exit;
+        }
+        build_sym_filter(p_pending + i);
+    }
+    // Load the images that don't import from pending images until all of them are loaded. If no image can be loaded
+    // in a pass, the remaining images import from each other.
+    while ((loaded < count) && progress) {
+        progress = 0;
+        for (i = 0; i < count; i ++) {
+            if ((p_pending[i].p_header == NULL) || imports_from_pending(p_pending + i, p_pending, count)) {
+                continue;
+            }
+            if ((p_mods[i] = udynlink_load_module(p_images[i], NULL, 0, load_mode, &res)) == NULL) {
+                goto exit;
+            }
+            p_pending[i].p_header = NULL;
+            loaded ++;
+            progress = 1;
+        }
+    }
+    if (loaded < count) {
+        res = UDYNLINK_ERR_LOAD_CIRCULAR_DEPENDENCY;
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)res]);
+    }
+
+exit:
+    udynlink_external_free(p_pending);
+    // On error, unload the modules that were loaded until no more modules can be unloaded (in reverse dependency
+    // order, since a module can't be unloaded before the modules that import from it)
+    for (progress = 1; (res != UDYNLINK_OK) && (loaded > 0) && progress; ) {
+        progress = 0;
+        for (i = 0; i < count; i ++) {
+            if ((p_mods[i] != NULL) && (udynlink_unload_module(p_mods[i]) == UDYNLINK_OK)) {
+                p_mods[i] = NULL;
+                loaded --;
+                progress = 1;
+            }
+        }
+    }
+    return res;
+}
+
 udynlink_error_t udynlink_unload_module(udynlink_module_t *p_mod) {
     if ((p_mod == NULL) || (p_mod->p_header == NULL)) {
         UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, error_codes[(int)UDYNLINK_ERR_INVALID_MODULE]);
         return UDYNLINK_ERR_INVALID_MODULE;
     }
+    if (p_mod->ref_count > 0) {
+        UDYNLINK_DEBUG(UDYNLINK_DEBUG_ERROR, "Module '%s' is still used by %u other module(s) or instance(s)\n", udynlink_get_module_name(p_mod), p_mod->ref_count);
+        return UDYNLINK_ERR_MODULE_IN_USE;
+    }
     UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Unloading module at %p\n", p_mod);
-    if ((p_mod->p_ram != NULL) && !UDYNLINK_LOAD_IS_FOREIGN_RAM(p_mod)) { // free allocated memory
-        udynlink_external_free(p_mod->p_ram);
-        UDYNLINK_DEBUG(UDYNLINK_DEBUG_INFO, "Deallocated memory area at %p\n", p_mod->p_ram);
+    for (uint32_t i = 0; i < p_mod->num_deps; i ++) {
+        p_mod->p_deps[i]->ref_count --;
+    }
+    if (p_mod->p_deps != NULL) {
+        udynlink_external_free(p_mod->p_deps);
     }
+    while (p_mod->p_thunks != NULL) {
+        udynlink_thunk_t *p_next = p_mod->p_thunks->p_next;
+        udynlink_external_free(p_mod->p_thunks);
+        p_mod->p_thunks = p_next;
+    }
+    if (p_mod->p_shared != NULL) { // remove the instance from the list of instances of its module
+        if (code_ranges[find_code_range(p_mod->p_shared, 0)].lot_base == p_mod->lot_base) { // the code can't use this instance anymore
+            udynlink_select_instance(p_mod->p_shared);
+        }
+        udynlink_module_t **pp;
+        for (pp = &p_mod->p_shared->p_next_instance; *pp != p_mod; pp = &(*pp)->p_next_instance);
+        *pp = p_mod->p_next_instance;
+        p_mod->p_shared->ref_count --;
+    } else {
+        remove_code_ranges(p_mod);
+        unindex_module(p_mod);
+        unindex_exports(p_mod);
+    }
+    free_module_ram(p_mod);
     mark_module_free(p_mod);
     return UDYNLINK_OK;
 }
@@ -357,17 +1945,21 @@ uint32_t udynlink_get_ram_size(const udynlink_module_t *p_mod) {
     const udynlink_module_header_t *p_header = p_mod->p_header;
     udynlink_load_mode_t load_mode = UDYNLINK_LOAD_GET_MODE(p_mod);
 
-    // RAM is always needed for relocations, .data and .bss section
-    uint32_t tot_size = p_header->num_lot * sizeof(uint32_t) + p_header->data_size + p_header->bss_size;
+    // RAM is always needed for relocations (unless the LOT is in flash), .data and .bss section
+    uint32_t tot_size = (UDYNLINK_LOAD_IS_FLASH_LOT(p_mod) ? 0 : p_header->num_lot * sizeof(uint32_t)) + p_header->data_size + p_header->bss_size;
     // Depending on the copy mode, more RAM might be needed:
     // - if only code is copied, add size of the code
     // - if everything is copied, add the size of the header (including the symbol table and the relocations) and the code
+    // - if the code is executed in place, add the size of .ramfunc (instances use the copy of their module)
     if (load_mode == UDYNLINK_LOAD_MODE_COPY_CODE) {
         tot_size += p_header->code_size;
     }
     else if (load_mode == UDYNLINK_LOAD_MODE_COPY_ALL) {
         tot_size += get_code_offset_from_header(p_header) + p_header->code_size;
     }
+    else if (p_mod->p_shared == NULL) {
+        tot_size += get_section_size(p_mod, UDYNLINK_SECTION_RAMFUNC);
+    }
     return tot_size;
 }
 
@@ -383,30 +1975,20 @@ const char *udynlink_get_module_name(const udynlink_module_t *p_mod) {
 }
 
 udynlink_module_t *udynlink_lookup_module(const char *name) {
-    for (uint32_t i = 0; i < UDYNLINK_MAX_HANDLES; i ++) {
-        if (module_table[i].p_header != NULL) { // there's a module here
-            if(!strcmp(name, udynlink_get_module_name(module_table + i))) {
-                return module_table + i;
-            }
-        }
-    }
-    return NULL;
+    return find_module(name, NULL);
 }
 
 udynlink_sym_t *udynlink_lookup_symbol(const udynlink_module_t *p_mod, const char *name, udynlink_sym_t *p_sym) {
-    uint32_t idx;
+    uint32_t hash = get_name_hash(name);
 
-    for (uint32_t i = 0; i < UDYNLINK_MAX_HANDLES; i ++) { // iterate through all modules
-        if ((p_mod == NULL) || (p_mod == module_table + i)) { // but consider only the given one if not NULL
-            idx = 0;
-            while (get_sym_at(module_table + i, idx ++, p_sym) != NULL) { // iterate through module's symbol table
-                if (!strcmp(p_sym->name, name)) { // symbol found
-                    return offset_sym(module_table + i, p_sym); // offset value properly before returning
-                }
-            }
+    if (p_mod != NULL) { // consider only the given module
+        if ((p_mod->p_header == NULL) || (find_sym(p_mod, name, hash, p_sym) == NULL)) {
+            return NULL;
         }
+    } else if ((p_mod = find_export(name, hash, p_sym)) == NULL) { // look for an exported symbol in all modules
+        return NULL;
     }
-    return NULL;
+    return offset_sym(p_mod, p_sym); // offset value properly before returning
 }
 
 uint32_t udynlink_get_symbol_value(const udynlink_module_t *p_mod, const char *name) {
@@ -423,22 +2005,65 @@ void udynlink_set_debug_level(udynlink_debug_level_t level) {
 }
 
 uint32_t udynlink_get_lot_base(uint32_t pc) {
-    udynlink_module_t *p_mod = module_table;
-    uint32_t code_base;
-
-    // Iterate through all loaded modules
-    for (uint32_t i = 0; i < UDYNLINK_MAX_HANDLES; i ++, p_mod ++) {
-        // Consider only loaded modules
-        if (p_mod->p_header != NULL) {
-            // Check PC limits
-            code_base = (uint32_t)get_code_pointer(p_mod);
-            if ((code_base <= pc) && (pc < code_base + p_mod->p_header->code_size)) {
-                return p_mod->ram_base;
-            }
+    uint32_t idx = last_range_idx, lo = 0, hi = num_code_ranges;
+
+    // Check the most recently hit range first
+    if ((idx < num_code_ranges) && (code_ranges[idx].code_start <= pc) && (pc < code_ranges[idx].code_end)) {
+        lot_cache_hits ++;
+        return code_ranges[idx].lot_base;
+    }
+    lot_cache_misses ++;
+    // Binary search for the last range that starts at or below pc
+    while (lo < hi) {
+        idx = (lo + hi) / 2;
+        if (code_ranges[idx].code_start <= pc) {
+            lo = idx + 1;
+        } else {
+            hi = idx;
         }
     }
+    if ((lo > 0) && (pc < code_ranges[lo - 1].code_end)) {
+        last_range_idx = lo - 1;
+        return code_ranges[lo - 1].lot_base;
+    }
     // Nothing found, so return 0
     // TODO: proper error handling here
     return 0;
 }
 
+void udynlink_get_export_index_stats(uint32_t *p_exports, uint32_t *p_duplicates) {
+    if (p_exports != NULL) {
+        *p_exports = num_exports;
+    }
+    if (p_duplicates != NULL) {
+        *p_duplicates = num_duplicate_exports;
+    }
+}
+
+uint32_t udynlink_add_handle_memory(void *p_mem, uint32_t size) {
+#if UDYNLINK_MAX_HANDLES > 0
+    (void)p_mem;
+    (void)size;
+    return 0;
+#else
+    return add_free_entries(p_mem, size);
+#endif
+}
+
+void udynlink_set_host_exports(const udynlink_host_export_t *p_exports, uint32_t count) {
+    host_exports = p_exports;
+    num_host_exports = count;
+}
+
+void udynlink_get_lot_base_stats(uint32_t *p_hits, uint32_t *p_misses) {
+    if (p_hits != NULL) {
+        *p_hits = lot_cache_hits;
+    }
+    if (p_misses != NULL) {
+        *p_misses = lot_cache_misses;
+    }
+}
+
+void udynlink_reset_lot_base_stats(void) {
+    lot_cache_hits = lot_cache_misses = 0;
+}
@@ -54,6 +54,23 @@ typedef enum {
     _UDYNLINK_LOAD_MODE_LAST = UDYNLINK_LOAD_MODE_XIP // for testing only
 } udynlink_load_mode_t;
 
+// Segments of a loaded module that can be placed in different RAM regions (see udynlink_load_module_placed)
+typedef enum {
+    UDYNLINK_SEGMENT_LOT,                       // LOT (followed by .data and .bss for modules that access their data relative to r9, or by .fastdata)
+    UDYNLINK_SEGMENT_DATA,                      // .data and .bss
+    UDYNLINK_SEGMENT_CODE,                      // code (COPY_CODE mode), the whole module image (COPY_ALL mode) or .ramfunc (XIP mode)
+    UDYNLINK_NUM_SEGMENTS
+} udynlink_segment_t;
+
+// RAM region descriptor: allocates and frees memory in a RAM region (for example CCM, TCM or external SDRAM).
+// p_alloc returns NULL if the region doesn't have enough free memory. p_free can be NULL if memory allocated in the
+// region is never freed.
+typedef struct {
+    void *(*p_alloc)(void *p_ctx, uint32_t size);
+    void (*p_free)(void *p_ctx, void *p_mem);
+    void *p_ctx;                                // argument for p_alloc and p_free
+} udynlink_region_t;
+
 // Representation of a loaded module in memory
 typedef struct _udynlink_module_t {
     const udynlink_module_header_t *p_header;   // pointer to module header
@@ -61,7 +78,18 @@ typedef struct _udynlink_module_t {
         void *p_ram;                            // pointer to module RAM
         uint32_t ram_base;                      // same thing as a number
     };
+    uint32_t lot_base;                          // address of the LOT (start of the RAM, or in flash for installed modules)
+    uint8_t *p_data;                            // address of .data (followed by .bss)
+    uint8_t *p_code_ram;                        // address of the code (COPY_CODE), the module image (COPY_ALL) or .ramfunc (XIP) in RAM
+    const udynlink_region_t * const *p_placement; // regions of the segments (NULL if the RAM is a single area at p_ram)
     uint8_t info;                               // load mode (above) and RAM ownserhsip info
+    uint32_t sym_filter[2];                     // bloom filter over the symbol names (used internally)
+    struct _udynlink_module_t **p_deps;         // modules that this module imports symbols from
+    uint16_t num_deps;                          // number of entries in p_deps
+    uint16_t ref_count;                         // number of loaded modules (and instances) that use this module
+    struct _udynlink_module_t *p_shared;        // module whose code is shared by this instance (NULL if not an instance)
+    struct _udynlink_module_t *p_next_instance; // next instance that shares the code of the same module
+    struct _udynlink_thunk_t *p_thunks;         // entry points of the exported functions (see udynlink_get_instance_symbol)
 } udynlink_module_t;
 
 // A symbol (mapping between a name and a value). Symbols can be both functions and
@@ -81,6 +109,13 @@ typedef struct {
     uint8_t location;                           // location (see above)
 } udynlink_sym_t;
 
+// Entry in the host export table used to resolve the imports of modules built with a host export manifest (see
+// udynlink_set_host_exports). The entry at index N is the host symbol with ordinal N in the manifest.
+typedef struct {
+    uint32_t addr;                              // address of the symbol (0 for unused ordinals)
+    uint32_t hash;                              // hash of the symbol name and ABI (computed by mkmanifest)
+} udynlink_host_export_t;
+
 // Error codes returned by various functions
 #define UDYNLINK_ERROR_CODES \
 _UDYNLINK_EXPAND(UDYNLINK_OK),\
@@ -93,7 +128,14 @@ _UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_INVALID_MODE),\
 _UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_BAD_RELOCATION_TABLE),\
 _UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_UNKNOWN_SYMBOL),\
 _UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_DUPLICATE_NAME),\
-_UDYNLINK_EXPAND(UDYNLINK_ERR_INVALID_MODULE)
+_UDYNLINK_EXPAND(UDYNLINK_ERR_INVALID_MODULE),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_MODULE_IN_USE),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_CIRCULAR_DEPENDENCY),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_BAD_COMPRESSED_DATA),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_LOAD_READ_ERROR),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_INSTALL_UNSUPPORTED_MODULE),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_INSTALL_FLASH_WRITE),\
+_UDYNLINK_EXPAND(UDYNLINK_ERR_INSTALL_INVALID)
 
 #define _UDYNLINK_EXPAND(x)                   x
 typedef enum {
@@ -101,6 +143,10 @@ typedef enum {
 } udynlink_error_t;
 #undef _UDYNLINK_EXPAND
 
+// Function that reads the next "size" bytes of a module image to p_buf (see udynlink_load_module_stream).
+// p_ctx is the argument given to udynlink_load_module_stream. Returns 1 if OK, 0 on error.
+typedef int (*udynlink_read_func_t)(void *p_ctx, void *p_buf, uint32_t size);
+
 // Debug levels for udynlink_debug (order is important!)
 // If this enum is modified, the correponding array in udynlink_debug must also be modified!
 typedef enum {
@@ -132,11 +178,92 @@ typedef enum {
 // p_error is filled with the error code.
 udynlink_module_t *udynlink_load_module(const void *base_addr, void *load_addr, uint32_t load_size, udynlink_load_mode_t load_mode, udynlink_error_t *p_error);
 
-// Unloads the specified module. Returns the status of the unload operation.
+// Loads a module with its segments placed in different RAM regions, instead of a single RAM area.
+// base_addr, load_mode, p_error - same as in udynlink_load_module.
+// p_placement - array of UDYNLINK_NUM_SEGMENTS entries with the region of each segment (see udynlink_segment_t), or
+//     NULL for a segment allocated with udynlink_external_malloc. The array and the regions must remain valid while
+//     the module is loaded. For modules that access their data relative to r9 (built with --relax-data or
+//     --toolchain=clang-rwpi), .data and .bss are placed in the region of the LOT. Otherwise, .fastdata (if the module
+//     has it and isn't compressed) is placed right after the LOT, in its region.
+// Returns a pointer to the module handle, or NULL for error.
+udynlink_module_t *udynlink_load_module_placed(const void *base_addr, const udynlink_region_t * const *p_placement, udynlink_load_mode_t load_mode, udynlink_error_t *p_error);
+
+// Loads a module whose image isn't memory mapped (for example a module in an SPI flash or on an SD card).
+// The image is read in order from start to end with p_read. The header is read directly to its place in RAM and the
+// code and the data are read (or decompressed, in compressed images) directly to their place, so the only extra RAM
+// needed is a buffer of UDYNLINK_STREAM_BUFFER_SIZE bytes on the stack for compressed images. The module is loaded in
+// the same way as with UDYNLINK_LOAD_MODE_COPY_ALL.
+// p_read - the function that reads the image.
+// p_ctx - argument for p_read.
+// load_addr, load_size, p_error - same as in udynlink_load_module.
+// Returns a pointer to the module handle, or NULL for error.
+udynlink_module_t *udynlink_load_module_stream(udynlink_read_func_t p_read, void *p_ctx, void *load_addr, uint32_t load_size, udynlink_error_t *p_error);
+
+// Installs a module image that is in flash, so that it can be loaded in XIP mode with its LOT in flash
+// (UDYNLINK_FLASH_LOT must be 1). The module is relocated once, for .data and .bss at a fixed RAM address. The LOT and
+// the relocated .data are written to flash with udynlink_external_flash_write. The module can import symbols only
+// from the firmware, and it can't access its data relative to r9 (built with --relax-data or --toolchain=clang-rwpi).
+// base_addr - the start address of the module image.
+// p_dest - the flash address where the installed module is written (udynlink_get_installed_size bytes).
+// ram_addr - the RAM address of .data and .bss (followed by .ramfunc, if any) when the installed module is loaded.
+// ram_size - the size of the RAM region at "ram_addr".
+// Returns the status of the operation.
+udynlink_error_t udynlink_install_module(const void *base_addr, void *p_dest, void *ram_addr, uint32_t ram_size);
+
+// Returns the size of the flash area needed to install the given module image (see udynlink_install_module).
+uint32_t udynlink_get_installed_size(const void *base_addr);
+
+// Loads a module installed with udynlink_install_module at p_installed. The module runs in XIP mode, with r9 pointing
+// to the LOT in flash. Only .data (copied from flash), .bss and .ramfunc need RAM.
+// Returns a pointer to the module handle, or NULL for error (p_error is filled with the error code if not NULL).
+udynlink_module_t *udynlink_load_installed_module(const void *p_installed, udynlink_error_t *p_error);
+
+// Creates a new instance of a loaded module. The instance shares the code of the module, but it has its own LOT, .data
+// (initialized from the module image) and .bss. The module must be loaded in UDYNLINK_LOAD_MODE_COPY_CODE or
+// UDYNLINK_LOAD_MODE_XIP mode from a memory mapped image (its image must remain valid while the instance is in use).
+// Instances are not in the module name index and don't export symbols to other modules, but their symbols can be
+// looked up with udynlink_lookup_symbol. The module can't be unloaded while it has instances.
+// An instance is unloaded with udynlink_unload_module.
+// p_mod - the module (or another instance of the module).
+// load_addr, load_size, p_error - same as in udynlink_load_module.
+// Returns a pointer to the instance handle, or NULL for error.
+udynlink_module_t *udynlink_create_instance(udynlink_module_t *p_mod, void *load_addr, uint32_t load_size, udynlink_error_t *p_error);
+
+// Returns the address of an exported symbol of an instance (or of the module itself). For a function, this is an
+// entry point that sets r9 to the LOT base of p_inst and calls the function without its export wrapper, so the call
+// doesn't depend on the selected instance (see udynlink_select_instance) and can run at the same time as calls into
+// other instances of the module (from interrupt handlers or other threads). The entry point of a function is allocated
+// with udynlink_external_malloc the first time it's requested for an instance, and it's freed when the instance is
+// unloaded. Functions that don't depend on r9 (exported without a wrapper) and data symbols are returned as they are.
+// Returns 0 if the symbol isn't exported by p_inst or if there isn't enough memory for the entry point.
+uint32_t udynlink_get_instance_symbol(udynlink_module_t *p_inst, const char *name);
+
+// Selects the instance used by the export wrappers of the shared code: the wrappers (and udynlink_get_lot_base) use
+// the LOT base of p_inst until another instance of the same module is selected. p_inst can also be the module itself,
+// which is selected when it's loaded. This applies to calls through the exported symbols (udynlink_lookup_symbol or
+// imports of other modules); calls through udynlink_get_instance_symbol don't need a selection.
+// NOTE: the selection is global state of the module, so calls through the exported symbols are NOT reentrant. An
+// interrupt handler or a thread that selects another instance while such a call is running must restore the previous
+// selection (the return value) before the call continues.
+// Returns the instance that was selected before, or NULL for error.
+udynlink_module_t *udynlink_select_instance(udynlink_module_t *p_inst);
+
+// Loads a set of modules that can import symbols from each other, in dependency order (a module is loaded after the
+// modules that export the symbols it imports). The modules are loaded in RAM allocated by the dynamic linker.
+// p_images - the images of the modules.
+// count - the number of images.
+// load_mode - specifies how the modules will be loaded to memory.
+// p_mods - array of "count" entries where the module handles will be written, in the same order as "p_images".
+// Returns the status of the operation. On error, none of the modules in the set remain loaded.
+udynlink_error_t udynlink_load_module_set(const void * const *p_images, uint32_t count, udynlink_load_mode_t load_mode, udynlink_module_t **p_mods);
+
+// Unloads the specified module. Returns the status of the unload operation. A module can't be unloaded while other
+// loaded modules import symbols from it (UDYNLINK_ERR_MODULE_IN_USE).
 udynlink_error_t udynlink_unload_module(udynlink_module_t *p_mod);
 
 // Return the RAM space required by the module.
-// This contains the LOT relocations + .data + .bss (+.text if the module was loaded with udynlink_load_module_copy).
+// This contains the LOT relocations + .data + .bss (+.text if the module was loaded with udynlink_load_module_copy,
+// or only .ramfunc in XIP mode).
 uint32_t udynlink_get_ram_size(const udynlink_module_t *p_mod);
 
 // Returns the name of the given module.
@@ -147,7 +274,8 @@ const char *udynlink_get_module_name(const udynlink_module_t *p_mod);
 udynlink_module_t *udynlink_lookup_module(const char *name);
 
 // Lookup the given symbol. Writes the result in p_sym.
-// p_module - pointer to the module to search, or NULL to search in all modules.
+// p_module - pointer to the module to search, or NULL to search the exported symbols of all modules (if more than
+// one module exports the symbol, the one that was loaded first is used, unless UDYNLINK_EXPORT_INDEX is 0).
 // name - name of the symbol
 // p_sym - structure to fill with information about the symbol
 // Returns p_sym if the symbol is found, false otherwise.
@@ -160,9 +288,32 @@ uint32_t udynlink_get_symbol_value(const udynlink_module_t *p_mod, const char *n
 // level - the debug level (see udynlink_debug_level_t above)
 void udynlink_set_debug_level(udynlink_debug_level_t level);
 
+// Sets the host export table used to resolve the imports of modules built with a host export manifest
+// (ordinal imports). The table must remain valid while it's in use. Imports by name are still resolved by
+// udynlink_external_resolve_symbol.
+void udynlink_set_host_exports(const udynlink_host_export_t *p_exports, uint32_t count);
+
+// Adds the given memory area to the pool of module handles (only when UDYNLINK_MAX_HANDLES is 0). Handles are
+// otherwise allocated with udynlink_external_malloc when needed; this can be used to pre-allocate them instead.
+// The memory area must remain valid for the lifetime of the program. Returns the number of handles added.
+uint32_t udynlink_add_handle_memory(void *p_mem, uint32_t size);
+
+// Return the statistics of the global export index: the number of indexed exports (in p_exports) and the number of
+// duplicate exports found since startup (in p_duplicates), i.e. symbols exported by a module when another loaded module
+// already exported a symbol with the same name. Both pointers can be NULL. Both values are 0 if the export index
+// is disabled (UDYNLINK_EXPORT_INDEX set to 0).
+void udynlink_get_export_index_stats(uint32_t *p_exports, uint32_t *p_duplicates);
+
 // Return the LOT address for the function at the given address
 uint32_t udynlink_get_lot_base(uint32_t pc);
 
+// Return the statistics of udynlink_get_lot_base: the number of calls served by the last hit cache (in p_hits)
+// and the number of calls that needed a search in the code range index (in p_misses). Both pointers can be NULL.
+void udynlink_get_lot_base_stats(uint32_t *p_hits, uint32_t *p_misses);
+
+// Reset the statistics of udynlink_get_lot_base
+void udynlink_reset_lot_base_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
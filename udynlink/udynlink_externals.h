@@ -29,9 +29,23 @@ void *udynlink_external_malloc(size_t size);
 void udynlink_external_free(void *p);
 void udynlink_external_vprintf(const char *s, va_list va);
 uint32_t udynlink_external_resolve_symbol(const char *name);
+// Only needed if UDYNLINK_FLASH_LOT is 1: write "size" bytes from p_src to flash at p_dst (erased as needed).
+// Returns 1 if OK, 0 on error.
+int udynlink_external_flash_write(void *p_dst, const void *p_src, uint32_t size);
 
 // UDYNLINK_MAX_HANDLES
 //     >0: that many modules
+//      0: no limit (handles are allocated with udynlink_external_malloc in chunks of UDYNLINK_HANDLE_CHUNK entries,
+//         or added with udynlink_add_handle_memory, and loaded modules are indexed by name)
+// UDYNLINK_EXPORT_INDEX
+//      1: keep a global index of the symbols exported by all loaded modules, allocated with udynlink_external_malloc
+//         (default)
+//      0: no global index, udynlink_lookup_symbol(NULL, ...) searches all loaded modules
+// UDYNLINK_STREAM_BUFFER_SIZE
+//     size of the buffer used by udynlink_load_module_stream to read compressed images (64 bytes by default)
+// UDYNLINK_FLASH_LOT
+//      1: enable udynlink_install_module (needs udynlink_external_flash_write)
+//      0: no module installation (default)
 
 #endif // #ifndef __UDYNLINK_EXTERNALS_H__
 